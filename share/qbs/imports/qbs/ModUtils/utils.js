@@ -48,20 +48,7 @@ function mergeCFiles(inputs, outputFilePath)
 }
 
 function sanitizedList(list, product, fullPropertyName) {
-    if (!Array.isArray(list))
-        return list;
-    var filterFunc = function(elem) {
-        if (typeof elem === "string" && elem.length === 0) {
-            var msg = "Removing empty string from value of property '" + fullPropertyName + "'";
-            // product might actually be a module
-            if (product.name)
-                msg += " in product '" + product.name + "'.";
-            console.warn(msg);
-            return false;
-        }
-        return true;
-    }
-    return list.filter(filterFunc);
+    return Utilities.sanitizedList(list, product, fullPropertyName);
 }
 
 function checkCompatibilityMode(project, minimumQbsVersion, message) {
@@ -224,17 +211,7 @@ function modulePropertyFromArtifacts(product, artifacts, moduleName, propertyNam
 }
 
 function concatAll() {
-    var result = [];
-    for (var i = 0; i < arguments.length; ++i) {
-        var arg = arguments[i];
-        if (arg === undefined)
-            continue;
-        else if (arg instanceof Array)
-            result = result.concat(arg);
-        else
-            result.push(arg);
-    }
-    return result;
+    return Utilities.concatAll.apply(Utilities, arguments);
 }
 
 function allFileTags(fileTaggers) {
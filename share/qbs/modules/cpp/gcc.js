@@ -388,14 +388,13 @@ function linkerFlags(project, product, inputs, outputs, primaryOutput, linkerPat
         args.push("-stdlib=" + stdlib);
 
     // Flags for library search paths
-    var allLibraryPaths = [];
-    if (libraryPaths)
-        allLibraryPaths = allLibraryPaths.uniqueConcat(libraryPaths);
-    if (distributionLibraryPaths)
-        allLibraryPaths = allLibraryPaths.uniqueConcat(distributionLibraryPaths);
-    if (systemRunPaths.length > 0)
-        allLibraryPaths = allLibraryPaths.filter(isNotSystemRunPath);
-    args = args.concat(allLibraryPaths.map(function(path) { return '-L' + path }));
+    var allLibraryPaths = [libraryPaths, distributionLibraryPaths];
+    if (systemRunPaths.length > 0) {
+        allLibraryPaths = allLibraryPaths.map(function(paths) {
+            return paths ? paths.filter(isNotSystemRunPath) : paths;
+        });
+    }
+    args = args.concat(Utilities.uniqueFlags('-L', allLibraryPaths));
 
     var linkerScripts = inputs.linkerscript
             ? inputs.linkerscript.map(function(a) { return a.filePath; }) : [];
@@ -531,17 +530,8 @@ function configFlags(config, isDriver) {
     if (frameworkPaths)
         args = args.concat(frameworkPaths.map(function(path) { return '-F' + path }));
 
-    var allSystemFrameworkPaths = [];
-
-    var systemFrameworkPaths = config.cpp.systemFrameworkPaths;
-    if (systemFrameworkPaths)
-        allSystemFrameworkPaths = allSystemFrameworkPaths.uniqueConcat(systemFrameworkPaths);
-
-    var distributionFrameworkPaths = config.cpp.distributionFrameworkPaths;
-    if (distributionFrameworkPaths)
-        allSystemFrameworkPaths = allSystemFrameworkPaths.uniqueConcat(distributionFrameworkPaths);
-
-    args = args.concat(allSystemFrameworkPaths.map(function(path) { return '-iframework' + path }));
+    args = args.concat(Utilities.uniqueFlags('-iframework', [config.cpp.systemFrameworkPaths,
+                                                            config.cpp.distributionFrameworkPaths]));
 
     return args;
 }
@@ -857,24 +847,11 @@ function compilerFlags(project, product, input, output, explicitlyDependsOn) {
     for (i in cppFlags)
         args.push('-Wp,' + cppFlags[i])
 
-    var allDefines = [];
-    if (platformDefines)
-        allDefines = allDefines.uniqueConcat(platformDefines);
-    if (defines)
-        allDefines = allDefines.uniqueConcat(defines);
-    args = args.concat(allDefines.map(function(define) { return '-D' + define }));
-    if (includePaths) {
-        args = args.concat([].uniqueConcat(includePaths).map(function(path) {
-            return input.cpp.includeFlag + path;
-        }));
-    }
-
-    var allSystemIncludePaths = [];
-    if (systemIncludePaths)
-        allSystemIncludePaths = allSystemIncludePaths.uniqueConcat(systemIncludePaths);
-    if (distributionIncludePaths)
-        allSystemIncludePaths = allSystemIncludePaths.uniqueConcat(distributionIncludePaths);
-    allSystemIncludePaths.forEach(function(v) { args.push(input.cpp.systemIncludeFlag, v); });
+    args = args.concat(Utilities.uniqueFlags('-D', [platformDefines, defines]));
+    args = args.concat(Utilities.uniqueFlags(input.cpp.includeFlag, [includePaths]));
+    args = args.concat(Utilities.uniqueFlags(input.cpp.systemIncludeFlag,
+                                             [systemIncludePaths, distributionIncludePaths],
+                                             true));
 
     var minimumWindowsVersion = input.cpp.minimumWindowsVersion;
     if (minimumWindowsVersion && product.qbs.targetOS.contains("windows")) {
@@ -969,14 +946,9 @@ function prepareAssembler(project, product, inputs, outputs, input, output) {
     args = args.concat(ModUtils.moduleProperty(input, 'platformFlags', tag),
                        ModUtils.moduleProperty(input, 'flags', tag));
 
-    var allIncludePaths = [];
-    if (includePaths)
-        allIncludePaths = allIncludePaths.uniqueConcat(includePaths);
-    if (systemIncludePaths)
-        allIncludePaths = allIncludePaths.uniqueConcat(systemIncludePaths);
-    if (distributionIncludePaths)
-        allIncludePaths = allIncludePaths.uniqueConcat(distributionIncludePaths);
-    args = args.concat(allIncludePaths.map(function(path) { return input.cpp.includeFlag + path }));
+    args = args.concat(Utilities.uniqueFlags(input.cpp.includeFlag,
+                                             [includePaths, systemIncludePaths,
+                                              distributionIncludePaths]));
 
     args.push("-o", output.filePath);
     args.push(input.filePath);
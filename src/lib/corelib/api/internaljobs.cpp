@@ -154,12 +154,13 @@ void InternalJob::shareObserverWith(InternalJob *otherJob)
     m_observer = otherJob->m_observer;
 }
 
-void InternalJob::storeBuildGraph(const TopLevelProjectPtr &project)
+void InternalJob::storeBuildGraph(const TopLevelProjectPtr &project,
+                                  BuildGraphStorageMode mode)
 {
     try {
         doSanityChecks(project, logger());
         TimedActivityLogger storeTimer(m_logger, Tr::tr("Storing build graph"), timed());
-        project->store(logger());
+        project->store(logger(), mode);
     } catch (const ErrorInfo &error) {
         ErrorInfo fullError = this->error();
         for (const ErrorItem &item : error.items())
@@ -266,6 +267,12 @@ void InternalSetupProjectJob::start()
                                                                                        projectId),
                                            logger(), m_parameters.waitLockBuildGraph(), observer());
             deleteLocker = true;
+        } else if (bgLocker) {
+            // A build job might still be writing the build graph file in the background.
+            // That write must not overtake the one for the new project.
+            const ErrorInfo writeError = bgLocker->waitForPendingWrite();
+            if (writeError.hasError())
+                logger().printWarning(writeError);
         }
         execute();
         if (m_existingProject)
@@ -312,7 +319,7 @@ void InternalSetupProjectJob::execute()
     }
 
     if (!m_parameters.dryRun())
-        storeBuildGraph(m_newProject);
+        storeBuildGraph(m_newProject, BuildGraphStorageMode::Synchronous);
 
     // The evalutation context cannot be re-used for building, which runs in a different thread.
     m_newProject->buildData->evaluationContext.reset();
@@ -360,8 +367,10 @@ void BuildGraphTouchingJob::setup(const TopLevelProjectPtr &project,
 
 void BuildGraphTouchingJob::storeBuildGraph()
 {
+    // The file is written in a separate thread, so the client does not have to wait for it.
+    // The build graph lock is held until the write has finished.
     if (!m_dryRun && !error().isInternalError())
-        InternalJob::storeBuildGraph(m_project);
+        InternalJob::storeBuildGraph(m_project, BuildGraphStorageMode::InBackground);
 }
 
 InternalBuildJob::InternalBuildJob(const Logger &logger, QObject *parent)
@@ -84,7 +84,7 @@ protected:
 
     JobObserver *observer() const { return m_observer; }
     void setTimed(bool timed) { m_timed = timed; }
-    void storeBuildGraph(const TopLevelProjectPtr &project);
+    void storeBuildGraph(const TopLevelProjectPtr &project, BuildGraphStorageMode mode);
 
 signals:
     void finished(Internal::InternalJob *job);
@@ -228,8 +228,10 @@ void Executor::doBuild()
     m_error.clear();
     m_explicitlyCanceled = false;
     m_activeFileTags = FileTags::fromStringList(m_buildOptions.activeFileTags());
+    m_activeFileTagsMask = FileTagMask(m_activeFileTags);
     m_tagsOfFilesToConsider.clear();
     m_tagsNeededForFilesToConsider.clear();
+    m_tagsNeededForFilesToConsiderMask = FileTagMask();
     m_productsOfFilesToConsider.clear();
     m_artifactsRemovedFromDisk.clear();
     m_jobCountPerPool.clear();
@@ -671,8 +673,8 @@ bool Executor::transformerHasMatchingOutputTags(const TransformerConstPtr &trans
 
 bool Executor::artifactHasMatchingOutputTags(const Artifact *artifact) const
 {
-    return m_activeFileTags.intersects(artifact->fileTags())
-            || m_tagsNeededForFilesToConsider.intersects(artifact->fileTags());
+    return m_activeFileTagsMask.intersects(artifact->fileTags())
+            || m_tagsNeededForFilesToConsiderMask.intersects(artifact->fileTags());
 }
 
 bool Executor::transformerHasMatchingInputFiles(const TransformerConstPtr &transformer) const
@@ -686,7 +688,7 @@ bool Executor::transformerHasMatchingInputFiles(const TransformerConstPtr &trans
     for (const Artifact * const input : qAsConst(transformer->inputs)) {
         for (const QString &filePath : m_buildOptions.filesToConsider()) {
             if (input->filePath() == filePath
-                    || input->fileTags().intersects(m_tagsNeededForFilesToConsider)) {
+                    || m_tagsNeededForFilesToConsiderMask.intersects(input->fileTags())) {
                 return true;
             }
         }
@@ -1272,11 +1274,13 @@ void Executor::setupForBuildingSelectedFiles(const BuildGraphNode *node)
         FileTags otherInputs = rule->auxiliaryInputs;
         otherInputs.unite(rule->explicitlyDependsOn).subtract(rule->excludedInputs);
         m_tagsNeededForFilesToConsider.unite(otherInputs);
+        m_tagsNeededForFilesToConsiderMask.unite(otherInputs);
     } else if (rule->collectedOutputFileTags().intersects(m_tagsNeededForFilesToConsider)) {
         FileTags allInputs = rule->inputs;
         allInputs.unite(rule->auxiliaryInputs).unite(rule->explicitlyDependsOn)
                 .subtract(rule->excludedInputs);
         m_tagsNeededForFilesToConsider.unite(allInputs);
+        m_tagsNeededForFilesToConsiderMask.unite(allInputs);
     }
 }
 
@@ -182,8 +182,10 @@ private:
     ErrorInfo m_error;
     bool m_explicitlyCanceled;
     FileTags m_activeFileTags;
+    FileTagMask m_activeFileTagsMask;
     FileTags m_tagsOfFilesToConsider;
     FileTags m_tagsNeededForFilesToConsider;
+    FileTagMask m_tagsNeededForFilesToConsiderMask;
     QList<ResolvedProductPtr> m_productsOfFilesToConsider;
     QTimer * const m_cancelationTimer;
     QStringList m_artifactsRemovedFromDisk;
@@ -136,7 +136,7 @@ private:
         scriptEngine->setGlobalObject(scope);
         if (importScopeForSourceCode.isObject())
             scriptEngine->currentContext()->pushScope(importScopeForSourceCode);
-        scriptEngine->evaluate(cmd->sourceCode());
+        scriptEngine->evaluateProgram(cmd->sourceCode(), cmd->codeLocation());
         scriptEngine->releaseResourcesOfScriptObjects();
         if (importScopeForSourceCode.isObject())
             scriptEngine->currentContext()->popScope();
@@ -270,11 +270,22 @@ void ProcessCommandExecutor::getProcessOutput(bool stdOut, ProcessResult &result
         redirectPath = processCommand()->stderrFilePath();
         target = &result.d->stdErr;
     }
-    QString contentString = filterProcessOutput(content, filterFunction);
-    if (!redirectPath.isEmpty()) {
-        const QProcess::ProcessError error = saveToFile(redirectPath, contentString.toLocal8Bit());
+    const auto saveOutput = [&redirectPath, &result](const QByteArray &output) {
+        const QProcess::ProcessError error = saveToFile(redirectPath, output);
         if (result.error() == QProcess::UnknownError && error != QProcess::UnknownError)
             result.d->error = error;
+    };
+
+    // Unfiltered output is only decoded if it ends up in the process result.
+    if (filterFunction.isEmpty() && (content.isEmpty() || !redirectPath.isEmpty())) {
+        if (!redirectPath.isEmpty())
+            saveOutput(content);
+        return;
+    }
+
+    QString contentString = filterProcessOutput(content, filterFunction);
+    if (!redirectPath.isEmpty()) {
+        saveOutput(contentString.toLocal8Bit());
     } else {
         if (!contentString.isEmpty() && contentString.endsWith(QLatin1Char('\n')))
             contentString.chop(1);
@@ -38,6 +38,7 @@
 ****************************************************************************/
 
 #include "rulecommands.h"
+#include <language/scriptengine.h>
 #include <logging/translator.h>
 #include <tools/error.h>
 #include <tools/fileinfo.h>
@@ -279,9 +280,14 @@ bool ProcessCommand::equals(const AbstractCommand *otherAbstractCommand) const
 void ProcessCommand::fillFromScriptValue(const QScriptValue *scriptValue, const CodeLocation &codeLocation)
 {
     AbstractCommand::fillFromScriptValue(scriptValue, codeLocation);
-    m_program = scriptValue->property(programProperty()).toString();
-    m_arguments = scriptValue->property(argumentsProperty()).toVariant().toStringList();
-    m_workingDir = scriptValue->property(workingDirProperty()).toString();
+
+    // Commands created by the same engine share equal strings and environments.
+    // Most of them have the same program, environment and a large part of their arguments.
+    const auto engine = static_cast<ScriptEngine *>(scriptValue->engine());
+    m_program = engine->internedString(scriptValue->property(programProperty()).toString());
+    m_arguments = engine->internedStrings(scriptValue->property(argumentsProperty()).toVariant()
+                                          .toStringList());
+    m_workingDir = engine->internedString(scriptValue->property(workingDirProperty()).toString());
     m_maxExitCode = scriptValue->property(maxExitCodeProperty()).toInt32();
 
     // toString() is required, presumably due to QtScript bug that manifests itself on Windows
@@ -306,6 +312,7 @@ void ProcessCommand::fillFromScriptValue(const QScriptValue *scriptValue, const
     QStringList envList = scriptValue->property(environmentProperty()).toVariant()
             .toStringList();
     getEnvironmentFromList(envList);
+    m_environment = engine->internedEnvironment(m_environment);
     m_stdoutFilePath = scriptValue->property(stdoutFilePathProperty()).toString();
     m_stderrFilePath = scriptValue->property(stderrFilePathProperty()).toString();
 
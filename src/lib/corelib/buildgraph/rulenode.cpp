@@ -232,6 +232,7 @@ int RuleNode::transformerCount() const
 
 ArtifactSet RuleNode::currentInputArtifacts() const
 {
+    const FileTagMask excludedInputs(m_rule->excludedInputs);
     ArtifactSet s;
     for (const FileTag &t : qAsConst(m_rule->inputs)) {
         for (Artifact *artifact : product->lookupArtifactsByFileTag(t)) {
@@ -242,7 +243,7 @@ ArtifactSet RuleNode::currentInputArtifacts() const
                 // This can e.g. happen for the ["cpp", "hpp"] -> ["hpp", "cpp", "unmocable"] rule.
                 continue;
             }
-            if (artifact->fileTags().intersects(m_rule->excludedInputs))
+            if (excludedInputs.intersects(artifact->fileTags()))
                 continue;
             s += artifact;
         }
@@ -256,18 +257,19 @@ ArtifactSet RuleNode::currentInputArtifacts() const
                 continue;
             if (artifact->transformer && artifact->transformer->rule == m_rule)
                 continue;
-            if (artifact->fileTags().intersects(m_rule->excludedInputs))
+            if (excludedInputs.intersects(artifact->fileTags()))
                 continue;
             s += artifact;
         }
     }
 
+    const FileTagMask inputsFromDependencies(m_rule->inputsFromDependencies);
     for (const ResolvedProductConstPtr &dep : qAsConst(product->dependencies)) {
         if (!dep->buildData)
             continue;
         for (Artifact * const a : filterByType<Artifact>(dep->buildData->allNodes())) {
-            if (a->fileTags().intersects(m_rule->inputsFromDependencies)
-                    && !a->fileTags().intersects(m_rule->excludedInputs))
+            if (inputsFromDependencies.intersects(a->fileTags())
+                    && !excludedInputs.intersects(a->fileTags()))
                 s += a;
         }
     }
@@ -276,7 +276,7 @@ void RulesApplicator::doApply(const ArtifactSet &inputArtifacts, QScriptValue &p
 
         QVariantMap artifactModulesCfg = outputArtifact->properties->value();
         for (const auto &binding : ra->bindings) {
-            scriptValue = engine()->evaluate(binding.code);
+            scriptValue = engine()->evaluateProgram(binding.code, binding.location);
             if (Q_UNLIKELY(engine()->hasErrorOrException(scriptValue))) {
                 QString msg = QLatin1String("evaluating rule binding '%1': %2");
                 throw ErrorInfo(msg.arg(binding.name.join(QLatin1Char('.')),
@@ -383,9 +383,8 @@ RulesApplicator::OutputArtifactInfo RulesApplicator::createOutputArtifactFromRul
     FileTags fileTags;
     bool alwaysUpdated;
     if (ruleArtifact) {
-        QScriptValue scriptValue = engine()->evaluate(ruleArtifact->filePath,
-                                                      ruleArtifact->filePathLocation.filePath(),
-                                                      ruleArtifact->filePathLocation.line());
+        QScriptValue scriptValue = engine()->evaluateProgram(ruleArtifact->filePath,
+                                                             ruleArtifact->filePathLocation);
         if (Q_UNLIKELY(engine()->hasErrorOrException(scriptValue)))
             throw engine()->lastError(scriptValue, ruleArtifact->filePathLocation);
         outputPath = scriptValue.toString();
@@ -514,9 +513,8 @@ QList<Artifact *> RulesApplicator::runOutputArtifactsScript(const ArtifactSet &i
         const QScriptValueList &args)
 {
     QList<Artifact *> lst;
-    QScriptValue fun = engine()->evaluate(m_rule->outputArtifactsScript.sourceCode(),
-                                          m_rule->outputArtifactsScript.location().filePath(),
-                                          m_rule->outputArtifactsScript.location().line());
+    QScriptValue fun = engine()->evaluateProgram(m_rule->outputArtifactsScript.sourceCode(),
+                                                 m_rule->outputArtifactsScript.location());
     if (!fun.isFunction())
         throw ErrorInfo(QLatin1String("Function expected."),
                         m_rule->outputArtifactsScript.location());
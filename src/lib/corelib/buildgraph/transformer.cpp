@@ -53,6 +53,8 @@
 
 #include <QtCore/qdir.h>
 
+#include <QtScript/qscriptcontext.h>
+
 #include <algorithm>
 
 namespace qbs {
@@ -132,6 +134,40 @@ static bool compareByFilePath(const Artifact *a1, const Artifact *a2)
     return a1->filePath() < a2->filePath();
 }
 
+enum InOutputsPropertyKeys : quint32 {
+    CachedValueKey,
+    ArtifactsKey,
+    DefaultModuleNameKey,
+};
+
+// The artifact objects are expensive to create, and rules with many inputs often access
+// only some of the file tags, so the list for a file tag gets created on first access.
+// Scripts may also assign to the property, as e.g. the lipo rule does; the assigned
+// value then replaces the list.
+static QScriptValue js_inOutputsForFileTag(QScriptContext *ctx, QScriptEngine *qtEngine)
+{
+    QScriptValue callee = ctx->callee();
+    if (ctx->argumentCount() == 1) {
+        callee.setProperty(CachedValueKey, ctx->argument(0));
+        return ctx->argument(0);
+    }
+    QScriptValue result = callee.property(CachedValueKey);
+    if (result.isValid())
+        return result;
+    const auto engine = static_cast<ScriptEngine *>(qtEngine);
+    const QVariantList artifacts = callee.property(ArtifactsKey).toVariant().toList();
+    const QString defaultModuleName = callee.property(DefaultModuleNameKey).toString();
+    result = engine->newArray(uint(artifacts.size()));
+    quint32 i = 0;
+    for (const QVariant &artifactPtr : artifacts) {
+        const auto artifact = reinterpret_cast<const Artifact *>(artifactPtr.value<quintptr>());
+        result.setProperty(i++, Transformer::translateFileConfig(engine, artifact,
+                                                                 defaultModuleName));
+    }
+    callee.setProperty(CachedValueKey, result);
+    return result;
+}
+
 QScriptValue Transformer::translateInOutputs(ScriptEngine *scriptEngine,
                                              const ArtifactSet &artifacts,
                                              const QString &defaultModuleName)
@@ -147,13 +183,15 @@ QScriptValue Transformer::translateInOutputs(ScriptEngine *scriptEngine,
     QScriptValue jsTagFiles = scriptEngine->newObject();
     for (TagArtifactsMap::const_iterator tag = tagArtifactsMap.constBegin(); tag != tagArtifactsMap.constEnd(); ++tag) {
         const QList<Artifact*> &artifacts = tag.value();
-        QScriptValue jsFileConfig = scriptEngine->newArray(artifacts.size());
-        int i = 0;
-        for (Artifact * const artifact : artifacts) {
-            jsFileConfig.setProperty(i++, translateFileConfig(scriptEngine, artifact,
-                                                              defaultModuleName));
-        }
-        jsTagFiles.setProperty(tag.key(), jsFileConfig);
+        QVariantList artifactPtrs;
+        artifactPtrs.reserve(artifacts.size());
+        for (Artifact * const artifact : artifacts)
+            artifactPtrs.push_back(QVariant::fromValue(reinterpret_cast<quintptr>(artifact)));
+        QScriptValue fileTagFunc = scriptEngine->newFunction(&js_inOutputsForFileTag);
+        fileTagFunc.setProperty(ArtifactsKey, scriptEngine->newVariant(artifactPtrs));
+        fileTagFunc.setProperty(DefaultModuleNameKey, defaultModuleName);
+        jsTagFiles.setProperty(tag.key(), fileTagFunc,
+                               QScriptValue::PropertyGetter | QScriptValue::PropertySetter);
     }
 
     return jsTagFiles;
@@ -239,9 +277,7 @@ void Transformer::createCommands(ScriptEngine *engine, const PrivateScriptFuncti
                                  const QScriptValueList &args)
 {
     if (!script.scriptFunction.isValid() || script.scriptFunction.engine() != engine) {
-        script.scriptFunction = engine->evaluate(script.sourceCode(),
-                                                  script.location().filePath(),
-                                                  script.location().line());
+        script.scriptFunction = engine->evaluateProgram(script.sourceCode(), script.location());
         if (Q_UNLIKELY(!script.scriptFunction.isFunction()))
             throw ErrorInfo(Tr::tr("Invalid prepare script."), script.location());
     }
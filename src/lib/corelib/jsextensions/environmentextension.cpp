@@ -89,10 +89,12 @@ QScriptValue EnvironmentExtension::js_getEnv(QScriptContext *context, QScriptEng
     const QProcessEnvironment env = static_cast<ScriptEngine *>(engine)->environment();
     const QProcessEnvironment *procenv = getProcessEnvironment(context, engine,
                                                                QStringLiteral("getEnv"), false);
-    if (!procenv)
+    const QString name = context->argument(0).toString();
+    if (!procenv) {
         procenv = &env;
+        static_cast<ScriptEngine *>(engine)->addRequestedEnvironmentVariable(name);
+    }
 
-    const QString name = context->argument(0).toString();
     const QString value = procenv->value(name);
     return value.isNull() ? engine->undefinedValue() : value;
 }
@@ -124,8 +126,10 @@ QScriptValue EnvironmentExtension::js_currentEnv(QScriptContext *context, QScrip
     const QProcessEnvironment env = static_cast<ScriptEngine *>(engine)->environment();
     const QProcessEnvironment *procenv = getProcessEnvironment(context, engine,
                                                                QStringLiteral("currentEnv"), false);
-    if (!procenv)
+    if (!procenv) {
         procenv = &env;
+        static_cast<ScriptEngine *>(engine)->setWholeEnvironmentRequested();
+    }
     QScriptValue envObject = engine->newObject();
     for (const QString &key : procenv->keys()) {
         const QString keyName = HostOsInfo::isWindowsHost() ? key.toUpper() : key;
@@ -79,15 +79,18 @@ static QScriptValue getModuleProperty(const ResolvedProduct *product, const Arti
     const PropertyMapConstPtr &properties = artifact ? artifact->properties
                                                      : product->moduleProperties;
     QVariant value;
-    if (engine->isPropertyCacheEnabled())
-        value = engine->retrieveFromPropertyCache(moduleName, propertyName, properties);
+    QScriptValue scriptValue;
+    if (engine->isPropertyCacheEnabled()) {
+        value = engine->retrieveFromPropertyCache(moduleName, propertyName, properties,
+                                                  &scriptValue);
+    }
     if (!value.isValid()) {
         value = properties->moduleProperty(moduleName, propertyName, isPresent);
 
-        // Cache the variant value. We must not cache the QScriptValue here, because it's a
-        // reference and the user might change the actual object.
+        // The engine only hands out script values from its cache that scripts cannot use
+        // to change the cached value.
         if (engine->isPropertyCacheEnabled())
-            engine->addToPropertyCache(moduleName, propertyName, properties, value);
+            scriptValue = engine->addToPropertyCache(moduleName, propertyName, properties, value);
     } else if (isPresent) {
         *isPresent = true;
     }
@@ -99,7 +102,7 @@ static QScriptValue getModuleProperty(const ResolvedProduct *product, const Arti
     else
         engine->addPropertyRequestedInScript(p);
 
-    return engine->toScriptValue(value);
+    return scriptValue.isValid() ? scriptValue : engine->toScriptValue(value);
 }
 
 class ModulePropertyScriptClass : public QScriptClass
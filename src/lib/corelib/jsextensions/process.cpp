@@ -130,7 +130,12 @@ QScriptValue Process::ctor(QScriptContext *context, QScriptEngine *engine)
     if (v.isNull()) {
         // The build environment is not initialized yet.
         // This can happen if one uses Process on the RHS of a binding like Group.name.
-        t->m_environment = static_cast<ScriptEngine *>(engine)->environment();
+        t->m_environment = se->environment();
+
+        // The process inherits all of the environment, but for the typical tools started
+        // by probes, the one variable that determines the outcome is the one used for
+        // looking up the executable.
+        se->addRequestedEnvironmentVariable(StringConstants::pathEnvVar());
     } else {
         t->m_environment
             = QProcessEnvironment(*reinterpret_cast<QProcessEnvironment*>(v.value<void*>()));
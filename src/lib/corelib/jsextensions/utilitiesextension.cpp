@@ -43,6 +43,7 @@
 #include <logging/translator.h>
 #include <tools/architectures.h>
 #include <tools/hostosinfo.h>
+#include <tools/set.h>
 #include <tools/stringconstants.h>
 #include <tools/toolchains.h>
 #include <tools/version.h>
@@ -91,6 +92,10 @@ public:
 
     static QScriptValue js_qmlTypeInfo(QScriptContext *context, QScriptEngine *engine);
     static QScriptValue js_builtinExtensionNames(QScriptContext *context, QScriptEngine *engine);
+
+    static QScriptValue js_concatAll(QScriptContext *context, QScriptEngine *engine);
+    static QScriptValue js_sanitizedList(QScriptContext *context, QScriptEngine *engine);
+    static QScriptValue js_uniqueFlags(QScriptContext *context, QScriptEngine *engine);
 };
 
 QScriptValue UtilitiesExtension::js_ctor(QScriptContext *context, QScriptEngine *engine)
@@ -504,6 +509,96 @@ QScriptValue UtilitiesExtension::js_builtinExtensionNames(QScriptContext *contex
     return engine->toScriptValue(JsExtensions::extensionNames());
 }
 
+static void appendArrayElements(QScriptValue &result, quint32 &resultLength,
+                                const QScriptValue &array)
+{
+    const quint32 length = array.property(StringConstants::lengthProperty()).toUInt32();
+    for (quint32 i = 0; i < length; ++i)
+        result.setProperty(resultLength++, array.property(i));
+}
+
+// Native implementation of ModUtils.concatAll().
+QScriptValue UtilitiesExtension::js_concatAll(QScriptContext *context, QScriptEngine *engine)
+{
+    QScriptValue result = engine->newArray();
+    quint32 resultLength = 0;
+    for (int i = 0; i < context->argumentCount(); ++i) {
+        const QScriptValue arg = context->argument(i);
+        if (arg.isUndefined())
+            continue;
+        if (arg.isArray())
+            appendArrayElements(result, resultLength, arg);
+        else
+            result.setProperty(resultLength++, arg);
+    }
+    return result;
+}
+
+// Native implementation of ModUtils.sanitizedList().
+QScriptValue UtilitiesExtension::js_sanitizedList(QScriptContext *context, QScriptEngine *engine)
+{
+    const QScriptValue list = context->argument(0);
+    if (!list.isArray())
+        return list;
+    QScriptValue result = engine->newArray();
+    quint32 resultLength = 0;
+    const quint32 length = list.property(StringConstants::lengthProperty()).toUInt32();
+    for (quint32 i = 0; i < length; ++i) {
+        const QScriptValue elem = list.property(i);
+        if (!elem.isString() || !elem.toString().isEmpty()) {
+            result.setProperty(resultLength++, elem);
+            continue;
+        }
+        // product might actually be a module
+        const QScriptValue productName
+                = context->argument(1).property(StringConstants::nameProperty());
+        const QString msg = productName.toBool()
+                ? QStringLiteral("Removing empty string from value of property '%1' "
+                                 "in product '%2'.")
+                  .arg(context->argument(2).toString(), productName.toString())
+                : QStringLiteral("Removing empty string from value of property '%1'")
+                  .arg(context->argument(2).toString());
+        static_cast<ScriptEngine *>(engine)->logger().qbsWarning() << msg;
+    }
+    return result;
+}
+
+// Utilities.uniqueFlags(flag, lists[, separateArguments]): Creates the command line arguments
+// for the values of all arrays in lists, skipping undefined lists and repeated values.
+// Each value is prepended by flag, or preceded by it as a separate argument.
+QScriptValue UtilitiesExtension::js_uniqueFlags(QScriptContext *context, QScriptEngine *engine)
+{
+    if (Q_UNLIKELY(context->argumentCount() < 2)) {
+        return context->throwError(QScriptContext::SyntaxError,
+                                   QStringLiteral("uniqueFlags expects at least 2 arguments"));
+    }
+    const QString flag = context->argument(0).toString();
+    const QScriptValue lists = context->argument(1);
+    const bool separateArguments = context->argument(2).toBool();
+    QScriptValue result = engine->newArray();
+    quint32 resultLength = 0;
+    Set<QString> seenValues;
+    const quint32 listCount = lists.property(StringConstants::lengthProperty()).toUInt32();
+    for (quint32 i = 0; i < listCount; ++i) {
+        const QScriptValue list = lists.property(i);
+        if (!list.isArray())
+            continue;
+        const quint32 length = list.property(StringConstants::lengthProperty()).toUInt32();
+        for (quint32 j = 0; j < length; ++j) {
+            const QString value = list.property(j).toString();
+            if (!seenValues.insert(value).second)
+                continue;
+            if (separateArguments) {
+                result.setProperty(resultLength++, flag);
+                result.setProperty(resultLength++, value);
+            } else {
+                result.setProperty(resultLength++, flag + value);
+            }
+        }
+    }
+    return result;
+}
+
 } // namespace Internal
 } // namespace qbs
 
@@ -548,6 +643,12 @@ void initializeJsExtensionUtilities(QScriptValue extensionObject)
                                engine->newFunction(UtilitiesExtension::js_qmlTypeInfo, 0));
     environmentObj.setProperty(QStringLiteral("builtinExtensionNames"),
                                engine->newFunction(UtilitiesExtension::js_builtinExtensionNames, 0));
+    environmentObj.setProperty(QStringLiteral("concatAll"),
+                               engine->newFunction(UtilitiesExtension::js_concatAll));
+    environmentObj.setProperty(QStringLiteral("sanitizedList"),
+                               engine->newFunction(UtilitiesExtension::js_sanitizedList, 3));
+    environmentObj.setProperty(QStringLiteral("uniqueFlags"),
+                               engine->newFunction(UtilitiesExtension::js_uniqueFlags, 3));
     extensionObject.setProperty(QStringLiteral("Utilities"), environmentObj);
 }
 
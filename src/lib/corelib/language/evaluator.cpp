@@ -237,6 +237,16 @@ void Evaluator::setCachingEnabled(bool enabled)
     m_scriptClass->setValueCacheEnabled(enabled);
 }
 
+bool Evaluator::isCachingEnabled() const
+{
+    return m_scriptClass->isValueCacheEnabled();
+}
+
+void Evaluator::setReadItemsCollector(Set<const Item *> *items)
+{
+    m_scriptClass->setReadItemsCollector(items);
+}
+
 PropertyDependencies Evaluator::propertyDependencies() const
 {
     return m_scriptClass->propertyDependencies();
@@ -93,6 +93,10 @@ public:
     FileContextScopes fileContextScopes(const FileContextConstPtr &file);
 
     void setCachingEnabled(bool enabled);
+    bool isCachingEnabled() const;
+
+    // While a collector is set, all items whose properties get read are added to it.
+    void setReadItemsCollector(Set<const Item *> *items);
 
     PropertyDependencies propertyDependencies() const;
     void clearPropertyDependencies();
@@ -335,8 +335,9 @@ private:
             if (sv.toBool())
                 elseCaseValue->setIsExclusiveListValue();
         }
-        result.scriptValue = engine->evaluate(value->sourceCodeForEvaluation(),
-                                              value->file()->filePath(), value->line());
+        result.scriptValue = engine->evaluateProgram(value->sourceCodeForEvaluation(),
+                                                     value->file()->filePath(), value->line(),
+                                                     value->column());
         return result;
     }
 
@@ -382,7 +383,7 @@ QScriptClass::QueryFlags EvaluatorScriptClass::queryProperty(const QScriptValue
         qDebug() << "[SC] queryProperty " << object.objectId() << " " << name;
 
     auto const data = attachedPointer<EvaluationData>(object);
-    const QString nameString = name.toString();
+    const QString nameString = propertyName(name);
     if (nameString == QStringLiteral("parent")) {
         *id = QPTParentProperty;
         m_queryResult.data = data;
@@ -430,6 +431,14 @@ QScriptClass::QueryFlags EvaluatorScriptClass::queryItemProperty(const Evaluatio
     return QScriptClass::QueryFlags();
 }
 
+QString EvaluatorScriptClass::propertyName(const QScriptString &name)
+{
+    auto it = m_propertyNames.constFind(name);
+    if (it == m_propertyNames.constEnd())
+        it = m_propertyNames.insert(name, name.toString());
+    return it.value();
+}
+
 QString EvaluatorScriptClass::resultToString(const QScriptValue &scriptValue)
 {
     return (scriptValue.isObject()
@@ -652,6 +661,8 @@ QScriptValue EvaluatorScriptClass::property(const QScriptValue &object, const QS
     m_queryResult.data = nullptr;
     m_queryResult.itemOfProperty = nullptr;
     QBS_ASSERT(data, return QScriptValue());
+    if (m_readItems)
+        m_readItems->insert(data->item);
 
     const auto qpt = static_cast<QueryPropertyType>(id);
     if (qpt == QPTParentProperty) {
@@ -682,7 +693,7 @@ QScriptValue EvaluatorScriptClass::property(const QScriptValue &object, const QS
     }
 
     if (value->next() && !m_currentNextChain.contains(value.get())) {
-        collectValuesFromNextChain(data, &result, name.toString(), value);
+        collectValuesFromNextChain(data, &result, propertyName(name), value);
     } else {
         QScriptValue parentObject;
         if (foundInParent)
@@ -691,7 +702,7 @@ QScriptValue EvaluatorScriptClass::property(const QScriptValue &object, const QS
                               &name, data, &result);
         converter.start();
 
-        const PropertyDeclaration decl = data->item->propertyDeclaration(name.toString());
+        const PropertyDeclaration decl = data->item->propertyDeclaration(propertyName(name));
         convertToPropertyType(data->item, decl, value.get(), result);
     }
 
@@ -706,47 +717,50 @@ class EvaluatorScriptClassPropertyIterator : public QScriptClassPropertyIterator
 {
 public:
     EvaluatorScriptClassPropertyIterator(const QScriptValue &object, EvaluationData *data)
-        : QScriptClassPropertyIterator(object), m_it(data->item->properties())
+        : QScriptClassPropertyIterator(object), m_properties(data->item->properties())
     {
     }
 
     bool hasNext() const override
     {
-        return m_it.hasNext();
+        return m_next != m_properties.cend();
     }
 
     void next() override
     {
-        m_it.next();
+        m_current = m_next++;
     }
 
     bool hasPrevious() const override
     {
-        return m_it.hasPrevious();
+        return m_next != m_properties.cbegin();
     }
 
     void previous() override
     {
-        m_it.previous();
+        m_current = --m_next;
     }
 
     void toFront() override
     {
-        m_it.toFront();
+        m_next = m_properties.cbegin();
     }
 
     void toBack() override
     {
-        m_it.toBack();
+        m_next = m_properties.cend();
     }
 
     QScriptString name() const override
     {
-        return object().engine()->toStringHandle(m_it.key());
+        return object().engine()->toStringHandle(m_current.key());
     }
 
 private:
-    QMapIterator<QString, ValuePtr> m_it;
+    // A copy, so the iterators stay valid if the item's properties change.
+    const Item::PropertyMap m_properties;
+    Item::PropertyMap::const_iterator m_next = m_properties.cbegin();
+    Item::PropertyMap::const_iterator m_current;
 };
 
 QScriptClassPropertyIterator *EvaluatorScriptClass::newIterator(const QScriptValue &object)
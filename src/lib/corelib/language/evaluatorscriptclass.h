@@ -45,7 +45,10 @@
 
 #include <tools/set.h>
 
+#include <QtCore/qhash.h>
+
 #include <QtScript/qscriptclass.h>
+#include <QtScript/qscriptstring.h>
 
 #include <stack>
 
@@ -73,9 +76,11 @@ public:
     QScriptClassPropertyIterator *newIterator(const QScriptValue &object) override;
 
     void setValueCacheEnabled(bool enabled);
+    bool isValueCacheEnabled() const { return m_valueCacheEnabled; }
+    void setReadItemsCollector(Set<const Item *> *items) { m_readItems = items; }
 
-    void convertToPropertyType(const PropertyDeclaration& decl, const CodeLocation &loc,
-                               QScriptValue &v);
+    static void convertToPropertyType(const PropertyDeclaration& decl, const CodeLocation &loc,
+                                      QScriptValue &v);
 
     PropertyDependencies propertyDependencies() const { return m_propertyDependencies; }
     void clearPropertyDependencies() { m_propertyDependencies.clear(); }
@@ -87,6 +92,7 @@ private:
     QueryFlags queryItemProperty(const EvaluationData *data,
                                  const QString &name,
                                  bool ignoreParent = false);
+    QString propertyName(const QScriptString &name);
     static QString resultToString(const QScriptValue &scriptValue);
     void collectValuesFromNextChain(const EvaluationData *data, QScriptValue *result, const QString &propertyName, const ValuePtr &value);
 
@@ -125,6 +131,10 @@ private:
     PropertyDependencies m_propertyDependencies;
     std::stack<QualifiedId> m_requestedProperties;
     QString m_pathPropertiesBaseDir;
+    Set<const Item *> *m_readItems = nullptr;
+
+    // Converting a QScriptString allocates a new QString every time.
+    QHash<QScriptString, QString> m_propertyNames;
 };
 
 } // namespace Internal
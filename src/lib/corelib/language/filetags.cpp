@@ -74,6 +74,21 @@ FileTags FileTags::fromStringList(const QStringList &strings)
     return result;
 }
 
+void FileTagMask::unite(const FileTags &tags)
+{
+    for (const FileTag &tag : tags) {
+        const int index = bitIndex(tag);
+        if (index < 0) {
+            m_otherTags.insert(tag);
+            continue;
+        }
+        const std::size_t word = std::size_t(index) / BitsPerWord;
+        if (word >= m_words.size())
+            m_words.resize(word + 1, 0);
+        m_words[word] |= quint64(1) << (index % BitsPerWord);
+    }
+}
+
 LogWriter operator <<(LogWriter w, const FileTags &tags)
 {
     bool firstLoop = true;
@@ -42,10 +42,14 @@
 
 #include <logging/logger.h>
 #include <tools/id.h>
+#include <tools/qbs_export.h>
 #include <tools/set.h>
 
 #include <QtCore/qdatastream.h>
 
+#include <algorithm>
+#include <vector>
+
 namespace qbs {
 namespace Internal {
 class PersistentPool;
@@ -86,6 +90,44 @@ public:
     static FileTags fromStringList(const QStringList &strings);
 };
 
+// A bit set representation of file tags, for when lots of FileTags objects are to be matched
+// against the same tags, as is the case e.g. for rule inputs. Ids are allocated consecutively,
+// so their values serve as dense bit indices. The FileTags API is still the one to use
+// for everything else.
+class QBS_AUTOTEST_EXPORT FileTagMask
+{
+public:
+    FileTagMask() = default;
+    explicit FileTagMask(const FileTags &tags) { unite(tags); }
+
+    void unite(const FileTags &tags);
+
+    bool empty() const { return m_words.empty() && m_otherTags.empty(); }
+    bool contains(const FileTag &tag) const
+    {
+        const int index = bitIndex(tag);
+        if (index < 0)
+            return m_otherTags.contains(tag);
+        const std::size_t word = std::size_t(index) / BitsPerWord;
+        return word < m_words.size() && (m_words[word] >> (index % BitsPerWord)) & 1;
+    }
+    bool intersects(const FileTags &tags) const
+    {
+        return !empty() && std::any_of(tags.cbegin(), tags.cend(),
+                                       [this](const FileTag &tag) { return contains(tag); });
+    }
+
+private:
+    static const int BitsPerWord = 64;
+    static int bitIndex(const FileTag &tag)
+    {
+        return tag.uniqueIdentifier() - Id::IdsPerPlugin * Id::ReservedPlugins;
+    }
+
+    std::vector<quint64> m_words;
+    FileTags m_otherTags; // Ids that were not created from a name.
+};
+
 LogWriter operator <<(LogWriter w, const FileTags &tags);
 QDebug operator<<(QDebug debug, const FileTags &tags);
 
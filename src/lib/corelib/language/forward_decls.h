@@ -45,6 +45,7 @@ namespace qbs {
 namespace Internal {
 
 enum class ObserveMode;
+enum class BuildGraphStorageMode;
 
 class Value;
 typedef std::shared_ptr<Value> ValuePtr;
@@ -47,6 +47,7 @@
 #include <parser/qmljsmemorypool_p.h>
 #include <tools/codelocation.h>
 #include <tools/error.h>
+#include <tools/vectormap.h>
 #include <tools/version.h>
 
 #include <QtCore/qlist.h>
@@ -83,8 +84,8 @@ public:
         VersionRange versionRange;
     };
     typedef std::vector<Module> Modules;
-    typedef QMap<QString, PropertyDeclaration> PropertyDeclarationMap;
-    typedef QMap<QString, ValuePtr> PropertyMap;
+    typedef VectorMap<QString, PropertyDeclaration> PropertyDeclarationMap;
+    typedef VectorMap<QString, ValuePtr> PropertyMap;
 
     static Item *create(ItemPool *pool, ItemType type);
     Item *clone() const;
@@ -126,6 +126,11 @@ Item *ItemReader::readFile(const QString &filePath)
     return m_visitorState->readFile(filePath, allSearchPaths(), m_pool);
 }
 
+void ItemReader::prefetchFiles(const QStringList &filePaths)
+{
+    m_visitorState->prefetchFiles(filePaths);
+}
+
 Set<QString> ItemReader::filesRead() const
 {
     return m_visitorState->filesRead();
@@ -79,6 +79,9 @@ public:
 
     Item *readFile(const QString &filePath);
 
+    // Starts parsing the given files in the background. Does not block.
+    void prefetchFiles(const QStringList &filePaths);
+
     Set<QString> filesRead() const;
 
     void setEnableTiming(bool on);
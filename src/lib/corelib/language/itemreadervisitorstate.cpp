@@ -48,58 +48,310 @@
 #include <parser/qmljsparser_p.h>
 #include <tools/error.h>
 
-#include <QtCore/qshareddata.h>
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qdatetime.h>
 #include <QtCore/qfile.h>
 #include <QtCore/qfileinfo.h>
-#include <QtCore/qshareddata.h>
+#include <QtCore/qrunnable.h>
 #include <QtCore/qtextstream.h>
+#include <QtCore/qthreadpool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
 
 namespace qbs {
 namespace Internal {
 
-class ASTCacheValueData : public QSharedData
+// The result of parsing a file. It is immutable and therefore can be shared between
+// resolve operations, which can run in different threads.
+class ParsedFile
 {
-    Q_DISABLE_COPY(ASTCacheValueData)
+    Q_DISABLE_COPY(ParsedFile)
 public:
-    ASTCacheValueData()
-        : ast(nullptr)
-        , processing(false)
-    {
-    }
+    ParsedFile() = default;
 
     QString code;
+    QByteArray contentHash;
     QbsQmlJS::Engine engine;
-    QbsQmlJS::AST::UiProgram *ast;
-    bool processing;
+    QbsQmlJS::AST::UiProgram *ast = nullptr;
 };
 
-class ASTCacheValue
+using ParsedFileConstPtr = std::shared_ptr<const ParsedFile>;
+
+static QByteArray contentHash(const QByteArray &content)
+{
+    return QCryptographicHash::hash(content, QCryptographicHash::Sha1);
+}
+
+static QByteArray readFileContent(const QString &filePath)
+{
+    QFile file(filePath);
+    if (Q_UNLIKELY(!file.open(QFile::ReadOnly)))
+        throw ErrorInfo(Tr::tr("Cannot open '%1'.").arg(filePath));
+    return file.readAll();
+}
+
+static ParsedFileConstPtr parseFile(const QString &filePath)
+{
+    const QByteArray content = readFileContent(filePath);
+    const auto parsedFile = std::make_shared<ParsedFile>();
+    parsedFile->contentHash = contentHash(content);
+    QTextStream stream(content);
+    stream.setCodec("UTF-8");
+    parsedFile->code = stream.readAll();
+    QbsQmlJS::Lexer lexer(&parsedFile->engine);
+    lexer.setCode(parsedFile->code, 1);
+    QbsQmlJS::Parser parser(&parsedFile->engine);
+
+    if (!parser.parse()) {
+        const QList<QbsQmlJS::DiagnosticMessage> &parserMessages = parser.diagnosticMessages();
+        if (Q_UNLIKELY(!parserMessages.empty())) {
+            ErrorInfo err;
+            for (const QbsQmlJS::DiagnosticMessage &msg : parserMessages)
+                err.append(msg.message, toCodeLocation(filePath, msg.loc));
+            throw err;
+        }
+    }
+    parsedFile->ast = parser.ast();
+    return parsedFile;
+}
+
+// Module and import files are the same for all projects, and project files rarely change
+// between two resolves. Clients that resolve more than once, such as IDEs, therefore keep
+// the parse results around for as long as the files do not change on disk. A matching time
+// stamp and size is not enough for that, because a file can be saved more than once within
+// the time stamp resolution of the file system, so the content is compared as well. The number
+// of files is bounded; the ones that have not been used for the longest time are dropped first.
+// Files that are known to be needed soon can be parsed ahead of time on worker threads;
+// a subsequent request for such a file then only waits for the pending result.
+class ProcessWideASTCache
 {
 public:
-    ASTCacheValue()
-        : d(new ASTCacheValueData)
+    static ParsedFileConstPtr parsedFile(const QString &filePath)
+    {
+        const QFileInfo fileInfo(filePath);
+        std::shared_future<ParsedFileConstPtr> future;
+        std::promise<ParsedFileConstPtr> promise;
+        bool mustParse = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!findEntry(filePath, fileInfo, &future)) {
+                future = promise.get_future().share();
+                m_entries.insert(filePath, Entry{fileInfo.lastModified(), fileInfo.size(),
+                                                 future, ++m_useCount});
+                mustParse = true;
+                evictLeastRecentlyUsed();
+            }
+        }
+        if (mustParse)
+            fulfill(filePath, promise);
+        ParsedFileConstPtr parsedFile;
+        try {
+            parsedFile = future.get();
+        } catch (const ErrorInfo &) {
+            forgetFailure(filePath);
+            throw;
+        }
+        if (!mustParse && contentHash(readFileContent(filePath)) != parsedFile->contentHash) {
+            forgetOutdated(filePath, parsedFile);
+            return ProcessWideASTCache::parsedFile(filePath);
+        }
+        return parsedFile;
+    }
+
+    // Returns a handle for the background work, which must be waited for before the
+    // caller goes away.
+    static std::future<void> prefetch(const QStringList &filePaths)
+    {
+        PrefetchTasks tasks;
+        std::vector<QFileInfo> fileInfos;
+        for (const QString &filePath : filePaths) {
+            fileInfos.emplace_back(filePath);
+            fileInfos.back().lastModified(); // Do the stat() call outside the lock.
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (const QFileInfo &fileInfo : fileInfos) {
+                const QString filePath = fileInfo.filePath();
+                std::shared_future<ParsedFileConstPtr> future;
+                if (findEntry(filePath, fileInfo, &future))
+                    continue;
+                std::promise<ParsedFileConstPtr> promise;
+                m_entries.insert(filePath, Entry{fileInfo.lastModified(), fileInfo.size(),
+                                                 promise.get_future().share(), ++m_useCount});
+                tasks.emplace_back(filePath, std::move(promise));
+            }
+            evictLeastRecentlyUsed();
+        }
+        if (tasks.empty())
+            return std::future<void>();
+        const int workerCount = std::min(int(tasks.size()), threadPool().maxThreadCount());
+        const auto batch = std::make_shared<PrefetchBatch>(std::move(tasks), workerCount);
+        for (int i = 0; i < workerCount; ++i)
+            threadPool().start(new PrefetchWorker(batch));
+        return batch->done.get_future();
+    }
+
+private:
+    using PrefetchTasks = std::vector<std::pair<QString, std::promise<ParsedFileConstPtr>>>;
+
+    // The files of one prefetch() call. The workers take the next unparsed file until
+    // there are none left, and the last one to finish reports the batch as done.
+    struct PrefetchBatch
+    {
+        PrefetchBatch(PrefetchTasks &&tasks, int workerCount)
+            : tasks(std::move(tasks)), activeWorkerCount(workerCount) {}
+
+        PrefetchTasks tasks;
+        std::atomic_int nextIndex{0};
+        std::atomic_int activeWorkerCount;
+        std::promise<void> done;
+    };
+
+    class PrefetchWorker : public QRunnable
+    {
+    public:
+        PrefetchWorker(const std::shared_ptr<PrefetchBatch> &batch) : m_batch(batch) {}
+
+    private:
+        void run() override
+        {
+            const int count = int(m_batch->tasks.size());
+            for (int i = m_batch->nextIndex++; i < count; i = m_batch->nextIndex++)
+                fulfill(m_batch->tasks.at(i).first, m_batch->tasks.at(i).second);
+            if (--m_batch->activeWorkerCount == 0)
+                m_batch->done.set_value();
+        }
+
+        const std::shared_ptr<PrefetchBatch> m_batch;
+    };
+
+    // Module searches happen all the time during resolving, so the threads are kept around
+    // instead of being started for every call to prefetch().
+    static QThreadPool &threadPool()
     {
+        static QThreadPool pool;
+        return pool;
     }
 
-    ASTCacheValue(const ASTCacheValue &other)
-        : d(other.d)
+    struct Entry
+    {
+        QDateTime lastModified;
+        qint64 size;
+        std::shared_future<ParsedFileConstPtr> parsedFile;
+        quint64 lastUse;
+    };
+
+    static bool findEntry(const QString &filePath, const QFileInfo &fileInfo,
+                          std::shared_future<ParsedFileConstPtr> *future)
     {
+        const auto it = m_entries.find(filePath);
+        if (it == m_entries.end() || it->lastModified != fileInfo.lastModified()
+                || it->size != fileInfo.size()) {
+            return false;
+        }
+        it->lastUse = ++m_useCount;
+        *future = it->parsedFile;
+        return true;
     }
 
-    void setProcessingFlag(bool b) { d->processing = b; }
-    bool isProcessing() const { return d->processing; }
+    // Entries that are still in use by a resolve operation or still being parsed stay alive
+    // via their shared pointers and futures, so they can be dropped at any time.
+    static void evictLeastRecentlyUsed()
+    {
+        static const int maxEntryCount = 2000;
+        if (m_entries.size() <= maxEntryCount)
+            return;
+        std::vector<quint64> useCounts;
+        useCounts.reserve(m_entries.size());
+        for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it)
+            useCounts.push_back(it->lastUse);
 
-    void setCode(const QString &code) { d->code = code; }
-    QString code() const { return d->code; }
+        // Make some room at once, so that eviction does not happen on every insertion.
+        const auto keptCount = size_t(maxEntryCount * 3 / 4);
+        const auto firstKept = useCounts.end() - keptCount;
+        std::nth_element(useCounts.begin(), firstKept, useCounts.end());
+        const quint64 minUseCountToKeep = *firstKept;
+        for (auto it = m_entries.begin(); it != m_entries.end();) {
+            if (it->lastUse < minUseCountToKeep)
+                it = m_entries.erase(it);
+            else
+                ++it;
+        }
+    }
 
-    QbsQmlJS::Engine *engine() const { return &d->engine; }
+    static void fulfill(const QString &filePath, std::promise<ParsedFileConstPtr> &promise)
+    {
+        try {
+            promise.set_value(parseFile(filePath));
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+        }
+    }
 
-    void setAst(QbsQmlJS::AST::UiProgram *ast) { d->ast = ast; }
-    QbsQmlJS::AST::UiProgram *ast() const { return d->ast; }
-    bool isValid() const { return d->ast; }
+    // Failures are not cached, so that a fixed file is picked up even if its time stamp
+    // and size did not change.
+    static void forgetFailure(const QString &filePath)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto it = m_entries.find(filePath);
+        if (it == m_entries.end()
+                || it->parsedFile.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return;
+        }
+        try {
+            it->parsedFile.get();
+        } catch (...) {
+            m_entries.erase(it);
+        }
+    }
+
+    static void forgetOutdated(const QString &filePath, const ParsedFileConstPtr &parsedFile)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto it = m_entries.find(filePath);
+        if (it == m_entries.end()
+                || it->parsedFile.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return;
+        }
+        try {
+            if (it->parsedFile.get() != parsedFile)
+                return; // Someone else has already replaced the entry.
+        } catch (...) {
+            return;
+        }
+        m_entries.erase(it);
+    }
+
+    static std::mutex m_mutex;
+    static QHash<QString, Entry> m_entries;
+    static quint64 m_useCount;
+};
+
+std::mutex ProcessWideASTCache::m_mutex;
+QHash<QString, ProcessWideASTCache::Entry> ProcessWideASTCache::m_entries;
+quint64 ProcessWideASTCache::m_useCount = 0;
+
+class ASTCacheValue
+{
+public:
+    void setProcessingFlag(bool b) { m_processing = b; }
+    bool isProcessing() const { return m_processing; }
+
+    void setParsedFile(const ParsedFileConstPtr &parsedFile) { m_parsedFile = parsedFile; }
+    QString code() const { return m_parsedFile->code; }
+    QbsQmlJS::AST::UiProgram *ast() const { return m_parsedFile->ast; }
+    bool isValid() const { return m_parsedFile && m_parsedFile->ast; }
 
 private:
-    QExplicitlySharedDataPointer<ASTCacheValueData> d;
+    ParsedFileConstPtr m_parsedFile;
+    bool m_processing = false;
 };
 
 class ItemReaderVisitorState::ASTCache : public QHash<QString, ASTCacheValue> {};
@@ -114,9 +366,29 @@ ItemReaderVisitorState::ItemReaderVisitorState(Logger &logger)
 
 ItemReaderVisitorState::~ItemReaderVisitorState()
 {
+    for (std::future<void> &prefetchJob : m_prefetchJobs)
+        prefetchJob.wait();
     delete m_astCache;
 }
 
+void ItemReaderVisitorState::prefetchFiles(const QStringList &filePaths)
+{
+    QStringList filesToParse;
+    for (const QString &filePath : filePaths) {
+        if (!m_astCache->contains(filePath))
+            filesToParse << filePath;
+    }
+    if (filesToParse.size() < 2)
+        return;
+    m_prefetchJobs.erase(std::remove_if(m_prefetchJobs.begin(), m_prefetchJobs.end(),
+                                        [](const std::future<void> &job) {
+        return job.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }), m_prefetchJobs.end());
+    std::future<void> prefetchJob = ProcessWideASTCache::prefetch(filesToParse);
+    if (prefetchJob.valid())
+        m_prefetchJobs.push_back(std::move(prefetchJob));
+}
+
 Item *ItemReaderVisitorState::readFile(const QString &filePath, const QStringList &searchPaths,
                                   ItemPool *itemPool)
 {
@@ -125,31 +397,8 @@ Item *ItemReaderVisitorState::readFile(const QString &filePath, const QStringLis
         if (Q_UNLIKELY(cacheValue.isProcessing()))
             throw ErrorInfo(Tr::tr("Loop detected when importing '%1'.").arg(filePath));
     } else {
-        QFile file(filePath);
-        if (Q_UNLIKELY(!file.open(QFile::ReadOnly)))
-            throw ErrorInfo(Tr::tr("Cannot open '%1'.").arg(filePath));
-
         m_filesRead.insert(filePath);
-        QTextStream stream(&file);
-        stream.setCodec("UTF-8");
-        const QString &code = stream.readAll();
-        QbsQmlJS::Lexer lexer(cacheValue.engine());
-        lexer.setCode(code, 1);
-        QbsQmlJS::Parser parser(cacheValue.engine());
-
-        file.close();
-        if (!parser.parse()) {
-            const QList<QbsQmlJS::DiagnosticMessage> &parserMessages = parser.diagnosticMessages();
-            if (Q_UNLIKELY(!parserMessages.empty())) {
-                ErrorInfo err;
-                for (const QbsQmlJS::DiagnosticMessage &msg : parserMessages)
-                    err.append(msg.message, toCodeLocation(filePath, msg.loc));
-                throw err;
-            }
-        }
-
-        cacheValue.setCode(code);
-        cacheValue.setAst(parser.ast());
+        cacheValue.setParsedFile(ProcessWideASTCache::parsedFile(filePath));
     }
 
     const FileContextPtr file = FileContext::create();
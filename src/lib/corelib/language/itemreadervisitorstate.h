@@ -44,6 +44,9 @@
 
 #include <QtCore/qstringlist.h>
 
+#include <future>
+#include <vector>
+
 namespace qbs {
 namespace Internal {
 class Item;
@@ -58,6 +61,7 @@ public:
     Set<QString> filesRead() const { return m_filesRead; }
 
     Item *readFile(const QString &filePath, const QStringList &searchPaths, ItemPool *itemPool);
+    void prefetchFiles(const QStringList &filePaths);
 
     void cacheDirectoryEntries(const QString &dirPath, const QStringList &entries);
     bool findDirectoryEntries(const QString &dirPath, QStringList *entries) const;
@@ -73,6 +77,7 @@ private:
 
     class ASTCache;
     ASTCache * const m_astCache;
+    std::vector<std::future<void>> m_prefetchJobs;
 };
 
 } // namespace Internal
@@ -626,12 +626,19 @@ QString TopLevelProject::buildGraphFilePath() const
     return ProjectBuildData::deriveBuildGraphFilePath(buildDirectory, id());
 }
 
-void TopLevelProject::store(Logger logger)
+void TopLevelProject::store(Logger logger, BuildGraphStorageMode mode)
 {
     // TODO: Use progress observer here.
 
     if (!buildData)
         return;
+    if (bgLocker) {
+        const ErrorInfo previousWriteError = bgLocker->waitForPendingWrite();
+        if (previousWriteError.hasError()) {
+            logger.printWarning(previousWriteError);
+            buildData->setDirty();
+        }
+    }
     if (!buildData->isDirty()) {
         qCDebug(lcBuildGraph) << "build graph is unchanged in project" << id();
         return;
@@ -644,7 +651,10 @@ void TopLevelProject::store(Logger logger)
     pool.setHeadData(headData);
     pool.setupWriteStream(fileName);
     store(pool);
-    pool.finalizeWriteStream();
+    if (mode == BuildGraphStorageMode::InBackground && bgLocker)
+        bgLocker->setPendingWrite(pool.finalizeWriteStreamInBackground());
+    else
+        pool.finalizeWriteStream();
     buildData->setClean();
 }
 
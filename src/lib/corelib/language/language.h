@@ -677,6 +677,8 @@ private:
     TopLevelProject *m_topLevelProject;
 };
 
+enum class BuildGraphStorageMode { Synchronous, InBackground };
+
 class QBS_AUTOTEST_EXPORT TopLevelProject : public ResolvedProject
 {
     friend class BuildGraphLoader;
@@ -712,7 +714,7 @@ public:
     QVariantMap overriddenValues;
 
     QString buildGraphFilePath() const;
-    void store(Logger logger);
+    void store(Logger logger, BuildGraphStorageMode mode = BuildGraphStorageMode::Synchronous);
 
 private:
     TopLevelProject();
@@ -29,6 +29,7 @@ HEADERS += \
     $$PWD/moduleloader.h \
     $$PWD/modulemerger.h \
     $$PWD/preparescriptobserver.h \
+    $$PWD/probecache.h \
     $$PWD/projectresolver.h \
     $$PWD/property.h \
     $$PWD/propertydeclaration.h \
@@ -63,6 +64,7 @@ SOURCES += \
     $$PWD/moduleloader.cpp \
     $$PWD/modulemerger.cpp \
     $$PWD/preparescriptobserver.cpp \
+    $$PWD/probecache.cpp \
     $$PWD/scriptpropertyobserver.cpp \
     $$PWD/projectresolver.cpp \
     $$PWD/property.cpp \
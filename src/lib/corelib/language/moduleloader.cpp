@@ -41,20 +41,26 @@
 
 #include "builtindeclarations.h"
 #include "evaluator.h"
+#include "evaluatorscriptclass.h"
 #include "filecontext.h"
+#include "identifiersearch.h"
 #include "item.h"
 #include "itemreader.h"
 #include "language.h"
 #include "modulemerger.h"
+#include "probecache.h"
 #include "qualifiedid.h"
 #include "scriptengine.h"
 #include "value.h"
 
 #include <api/languageinfo.h>
+#include <buildgraph/buildgraph.h>
 #include <language/language.h>
 #include <logging/categories.h>
 #include <logging/logger.h>
 #include <logging/translator.h>
+#include <parser/qmljslexer_p.h>
+#include <parser/qmljsparser_p.h>
 #include <tools/error.h>
 #include <tools/fileinfo.h>
 #include <tools/preferences.h>
@@ -71,11 +77,16 @@
 #include <QtCore/qdebug.h>
 #include <QtCore/qdir.h>
 #include <QtCore/qdiriterator.h>
+#include <QtCore/qeventloop.h>
 #include <QtCore/qjsondocument.h>
 #include <QtCore/qjsonobject.h>
+#include <QtCore/qprocess.h>
+#include <QtCore/qtimer.h>
 #include <QtScript/qscriptvalueiterator.h>
 
 #include <algorithm>
+#include <future>
+#include <mutex>
 #include <utility>
 
 namespace qbs {
@@ -93,7 +104,8 @@ static void handlePropertyError(const ErrorInfo &error, const SetupProjectParame
 
 class ModuleLoader::ItemModuleList : public QList<Item::Module> {};
 
-static QString probeGlobalId(Item *probe)
+// If a project directory is given, probes in files below it are identified relative to it.
+static QString probeGlobalId(Item *probe, const QString &projectDirectory = QString())
 {
     QString id;
 
@@ -108,7 +120,12 @@ static QString probeGlobalId(Item *probe)
         return QString();
 
     QBS_CHECK(probe->file());
-    return id + QLatin1Char('_') + probe->file()->filePath();
+    const QString &filePath = probe->file()->filePath();
+    if (!projectDirectory.isEmpty()
+            && filePath.startsWith(projectDirectory + QLatin1Char('/'))) {
+        return id + QLatin1Char('_') + filePath.mid(projectDirectory.size() + 1);
+    }
+    return id + QLatin1Char('_') + filePath;
 }
 
 class ModuleLoader::ProductSortByDependencies
@@ -275,6 +292,7 @@ ModuleLoaderResult ModuleLoader::load(const SetupProjectParameters &parameters)
     m_parameters = parameters;
     m_modulePrototypes.clear();
     m_modulePrototypeEnabledInfo.clear();
+    m_existingModulePathCache.clear();
     m_parameterDeclarations.clear();
     m_disabledItems.clear();
     m_reader->clearExtraSearchPathsStack();
@@ -283,8 +301,16 @@ ModuleLoaderResult ModuleLoader::load(const SetupProjectParameters &parameters)
             = m_elapsedTimeProductDependencies = m_elapsedTimeTransitiveDependencies
             = m_elapsedTimePropertyChecking = 0;
     m_elapsedTimeProbes = 0;
-    m_probesEncountered = m_probesRun = m_probesCachedCurrent = m_probesCachedOld = 0;
+    m_probesEncountered = m_probesRun = m_probesCachedCurrent = m_probesCachedOld
+            = m_probesCachedPersistently = 0;
     m_settings.reset(new Settings(parameters.settingsDirectory()));
+    const QString probeCacheFilePath = ProbeCache::filePathFromEnvironment();
+    if (probeCacheFilePath.isEmpty() || parameters.forceProbeExecution()) {
+        m_probeCache.reset();
+    } else {
+        m_probeCache.reset(new ProbeCache(probeCacheFilePath, parameters.adjustedEnvironment(),
+                                          m_logger));
+    }
 
     for (const QString &key : m_parameters.overriddenValues().keys()) {
         static const QStringList prefixes({ StringConstants::projectPrefix(),
@@ -353,6 +379,8 @@ ModuleLoaderResult ModuleLoader::load(const SetupProjectParameters &parameters)
     result.qbsFiles = m_reader->filesRead();
     for (auto it = m_localProfiles.cbegin(); it != m_localProfiles.cend(); ++it)
         result.profileConfigs.remove(it.key());
+    if (m_probeCache)
+        m_probeCache->store();
     printProfilingInfo();
     return result;
 }
@@ -684,6 +712,15 @@ void ModuleLoader::handleProject(ModuleLoaderResult *loadResult,
                 projectItem, StringConstants::referencesProperty());
     const CodeLocation referencingLocation
             = projectItem->property(StringConstants::referencesProperty())->location();
+    QStringList referencedFilesToPrefetch;
+    for (const QString &filePath : refs) {
+        const QString absFilePath = FileInfo::resolvePath(
+                    FileInfo::path(referencingLocation.filePath()), filePath);
+        const FileInfo fileInfo(absFilePath);
+        if (fileInfo.exists() && !fileInfo.isDir())
+            referencedFilesToPrefetch << absFilePath;
+    }
+    m_reader->prefetchFiles(referencedFilesToPrefetch);
     QList<Item *> additionalProjectChildren;
     for (const QString &filePath : refs) {
         try {
@@ -1231,15 +1268,19 @@ void ModuleLoader::setupProductDependencies(ProductContext *productContext,
 
 // Leaf modules first.
 // TODO: Can this be merged with addTransitiveDependencies? Looks suspiciously similar.
-void ModuleLoader::createSortedModuleList(const Item::Module &parentModule, Item::Modules &modules)
+template<typename T> bool insertIntoSet(Set<T> &set, const T &value)
+{
+    const auto insertionResult = set.insert(value);
+    return insertionResult.second;
+}
+
+void ModuleLoader::createSortedModuleList(const Item::Module &parentModule, Item::Modules &modules,
+                                          QualifiedIdSet &seenModules)
 {
-    if (std::find_if(modules.cbegin(), modules.cend(),
-                     [parentModule](const Item::Module &m) { return m.name == parentModule.name;})
-            != modules.cend()) {
+    if (!insertIntoSet(seenModules, parentModule.name))
         return;
-    }
     for (const Item::Module &dep : parentModule.item->modules())
-        createSortedModuleList(dep, modules);
+        createSortedModuleList(dep, modules, seenModules);
     modules.push_back(parentModule);
     return;
 }
@@ -1248,30 +1289,23 @@ Item::Modules ModuleLoader::modulesSortedByDependency(const Item *productItem)
 {
     QBS_CHECK(productItem->type() == ItemType::Product);
     Item::Modules sortedModules;
+    QualifiedIdSet seenModules;
     const Item::Modules &unsortedModules = productItem->modules();
     for (const Item::Module &module : unsortedModules)
-        createSortedModuleList(module, sortedModules);
+        createSortedModuleList(module, sortedModules, seenModules);
     QBS_CHECK(sortedModules.size() == unsortedModules.size());
 
     // Make sure the top-level items stay the same.
-    for (Item::Module &s : sortedModules) {
-        for (const Item::Module &u : unsortedModules) {
-            if (s.name == u.name) {
-                s.item = u.item;
-                break;
-            }
-        }
-    }
+    QHash<QualifiedId, Item *> topLevelItems;
+    topLevelItems.reserve(int(unsortedModules.size()));
+    for (const Item::Module &u : unsortedModules)
+        topLevelItems.insert(u.name, u.item);
+    for (Item::Module &s : sortedModules)
+        s.item = topLevelItems.value(s.name, s.item);
     return sortedModules;
 }
 
 
-template<typename T> bool insertIntoSet(Set<T> &set, const T &value)
-{
-    const auto insertionResult = set.insert(value);
-    return insertionResult.second;
-}
-
 void ModuleLoader::setupReverseModuleDependencies(const Item::Module &module,
                                                   ModuleDependencies &deps,
                                                   QualifiedIdSet &seenModules)
@@ -1674,7 +1708,7 @@ static void mergeProperty(Item *dst, const QString &name, const ValuePtr &value)
         const ItemValueConstPtr itemValue = std::static_pointer_cast<ItemValue>(value);
         const Item * const valueItem = itemValue->item();
         Item * const subItem = dst->itemProperty(name, itemValue)->item();
-        for (QMap<QString, ValuePtr>::const_iterator it = valueItem->properties().constBegin();
+        for (Item::PropertyMap::const_iterator it = valueItem->properties().constBegin();
                 it != valueItem->properties().constEnd(); ++it)
             mergeProperty(subItem, it.key(), it.value());
     } else {
@@ -1774,6 +1808,12 @@ ProbeConstPtr ModuleLoader::findCurrentProbe(
     return ProbeConstPtr();
 }
 
+// Unlike the global id, this does not change when the project is checked out elsewhere.
+QString ModuleLoader::probeCacheKey(Item *probe) const
+{
+    return probeGlobalId(probe, FileInfo::path(m_parameters.projectFilePath()));
+}
+
 bool ModuleLoader::probeMatches(const ProbeConstPtr &probe, bool condition,
         const QVariantMap &initialProperties, const QString &configureScript,
         CompareScript compareScript) const
@@ -1809,9 +1849,10 @@ void ModuleLoader::printProfilingInfo()
                                          .arg(elapsedTimeString(m_elapsedTimeProbes));
     m_logger.qbsLog(LoggerInfo, true) << "\t\t"
             << Tr::tr("%1 probes encountered, %2 configure scripts executed, "
-                      "%3 re-used from current run, %4 re-used from earlier run.")
+                      "%3 re-used from current run, %4 re-used from earlier run, "
+                      "%5 re-used from probe cache.")
                .arg(m_probesEncountered).arg(m_probesRun).arg(m_probesCachedCurrent)
-               .arg(m_probesCachedOld);
+               .arg(m_probesCachedOld).arg(m_probesCachedPersistently);
     m_logger.qbsLog(LoggerInfo, true) << "\t"
                                       << Tr::tr("Property checking took %1.")
                                          .arg(elapsedTimeString(m_elapsedTimePropertyChecking));
@@ -1908,7 +1949,7 @@ bool ModuleLoader::mergeExportItems(const ProductContext &productContext)
             }
             merged->setPropertyDeclaration(newDecl.name(), newDecl);
         }
-        for (QMap<QString, ValuePtr>::const_iterator it = exportItem->properties().constBegin();
+        for (Item::PropertyMap::const_iterator it = exportItem->properties().constBegin();
                 it != exportItem->properties().constEnd(); ++it) {
             mergeProperty(merged, it.key(), it.value());
         }
@@ -2972,6 +3013,8 @@ Item *ModuleLoader::searchAndLoadModuleFile(ProductContext *productContext,
     const QString fullName = moduleName.toString();
     std::vector<PrioritizedItem> candidates;
     const QStringList &searchPaths = m_reader->allSearchPaths();
+    std::vector<std::pair<int, QString>> moduleDirPaths;
+    QStringList allModuleFileNames;
     for (int i = 0; i < searchPaths.size(); ++i) {
         const QString &path = searchPaths.at(i);
         const QString dirPath = findExistingModulePath(path, moduleName);
@@ -2985,7 +3028,19 @@ Item *ModuleLoader::searchAndLoadModuleFile(ProductContext *productContext,
 
             m_moduleDirListCache.insert(dirPath, moduleFileNames);
         }
-        for (const QString &filePath : qAsConst(moduleFileNames)) {
+        moduleDirPaths.emplace_back(i, dirPath);
+        allModuleFileNames += moduleFileNames;
+    }
+
+    // Modules often come with one file per toolchain or platform, all of which
+    // have to be parsed to evaluate their conditions.
+    m_reader->prefetchFiles(allModuleFileNames);
+
+    for (const auto &indexAndDirPath : moduleDirPaths) {
+        const int i = indexAndDirPath.first;
+        const QString &dirPath = indexAndDirPath.second;
+        const QStringList moduleFileNames = m_moduleDirListCache.value(dirPath);
+        for (const QString &filePath : moduleFileNames) {
             triedToLoadModule = true;
             Item *module = loadModuleFile(productContext, fullName, isBaseModule(moduleName),
                                           filePath, &triedToLoadModule, moduleInstance);
@@ -3087,6 +3142,18 @@ static Item *findDeepestModuleInstance(Item *instance)
     return instance;
 }
 
+// Most modules do not have a condition. There is no need to evaluate the built-in default
+// for every product then.
+static bool hasDefaultCondition(const Item *item)
+{
+    const ValuePtr value = item->property(StringConstants::conditionProperty());
+    if (!value || value->type() != Value::JSSourceValueType || value->next())
+        return false;
+    const JSSourceValuePtr sourceValue = std::static_pointer_cast<JSSourceValue>(value);
+    return sourceValue->isBuiltinDefaultValue() && sourceValue->alternatives().empty()
+            && sourceValue->sourceCode() == StringConstants::trueValue();
+}
+
 Item *ModuleLoader::loadModuleFile(ProductContext *productContext, const QString &fullModuleName,
         bool isBaseModule, const QString &filePath, bool *triedToLoad, Item *moduleInstance)
 {
@@ -3111,7 +3178,8 @@ Item *ModuleLoader::loadModuleFile(ProductContext *productContext, const QString
     Item *deepestModuleInstance = findDeepestModuleInstance(moduleInstance);
     Item *origDeepestModuleInstancePrototype = deepestModuleInstance->prototype();
     deepestModuleInstance->setPrototype(module);
-    bool enabled = checkItemCondition(moduleInstance, module);
+    const bool enabled = hasDefaultCondition(moduleInstance)
+            || checkItemCondition(moduleInstance, module);
     deepestModuleInstance->setPrototype(origDeepestModuleInstancePrototype);
     if (!enabled) {
         qCDebug(lcModuleLoader) << "condition of module" << fullModuleName << "is false";
@@ -3385,30 +3453,152 @@ void ModuleLoader::createChildInstances(Item *instance, Item *prototype,
     }
 }
 
+// Connects the thread resolving the probes with a configure script running in a separate
+// engine. The former can abort the script, and the latter wakes up the former when it is done.
+class ConfigureScriptControl
+{
+public:
+    bool setEngine(ScriptEngine *engine)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_engine = engine;
+        return !m_canceled;
+    }
+
+    void cancel()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_canceled = true;
+        if (m_engine)
+            m_engine->cancel();
+    }
+
+    // Returns false if the script has already finished, in which case there is no need to wait.
+    bool setWaitingLoop(QEventLoop *loop)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_waitingLoop = loop;
+        return !m_finished;
+    }
+
+    void setFinished()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_finished = true;
+        if (m_waitingLoop)
+            QMetaObject::invokeMethod(m_waitingLoop, "quit", Qt::QueuedConnection);
+    }
+
+private:
+    std::mutex m_mutex;
+    ScriptEngine *m_engine = nullptr;
+    QEventLoop *m_waitingLoop = nullptr;
+    bool m_canceled = false;
+    bool m_finished = false;
+};
+
+struct ModuleLoader::ConfigureScriptResult
+{
+    QVariantMap properties;
+    std::vector<QString> importedFilesUsed;
+    Set<QString> requestedEnvironmentVariables;
+    bool wholeEnvironmentRequested = false;
+    ErrorInfo error;
+};
+
+struct ModuleLoader::ProbeResolution
+{
+    QString probeId;
+    JSSourceValueConstPtr configureScript;
+    QList<std::pair<QString, QScriptValue>> bindings;
+    QVariantMap initialProperties;
+    bool condition = false;
+    ProbeConstPtr resolvedProbe;
+    bool cachedFromEarlierRun = false;
+    bool cachedPersistently = false;
+
+    // Set if the configure script was run in a separate engine.
+    std::future<ConfigureScriptResult> configureScriptResult;
+    std::shared_ptr<ConfigureScriptControl> control;
+};
+
+// Probes usually spend most of their time waiting for the processes they start. Therefore,
+// we run the configure scripts of all probes of an item concurrently if the probes' input
+// values do not depend on each other. A probe whose properties might refer to other probes
+// is resolved later in the usual way, after all probes preceding it.
 void ModuleLoader::resolveProbes(ProductContext *productContext, Item *item)
 {
     AccumulatingTimer probesTimer(m_parameters.logElapsedTime() ? &m_elapsedTimeProbes : nullptr);
     EvalContextSwitcher evalContextSwitcher(m_evaluator->engine(), EvalContext::ProbeExecution);
+    std::vector<Item *> probes;
     for (Item * const child : item->children())
         if (child->type() == ItemType::Probe)
-            resolveProbe(productContext, item, child);
+            probes.push_back(child);
+
+    // Dependencies between probes are detected by observing which items are accessed when
+    // evaluating the probes' properties. Cached values would hide such accesses.
+    if (probes.size() < 2 || m_evaluator->isCachingEnabled()) {
+        for (Item * const probe : probes)
+            resolveProbe(productContext, item, probe);
+        return;
+    }
+
+    std::vector<ProbeResolution> resolutions(probes.size());
+    std::vector<bool> isIndependent(probes.size(), false);
+    for (size_t i = 0; i < probes.size(); ++i) {
+        Set<const Item *> itemsRead;
+        m_evaluator->setReadItemsCollector(&itemsRead);
+        try {
+            resolutions[i] = prepareProbe(productContext, item, probes[i]);
+            isIndependent[i] = none_of(probes, [&itemsRead, &probes, i](const Item *p) {
+                return p != probes[i] && itemsRead.contains(p);
+            });
+        } catch (const ErrorInfo &) {
+            // Will be reported when resolving the probe in the usual way.
+        }
+        m_evaluator->setReadItemsCollector(nullptr);
+    }
+
+    for (size_t i = 0; i < probes.size(); ++i) {
+        if (isIndependent[i])
+            startConfigureScriptInSeparateEngine(probes[i], resolutions[i]);
+    }
+
+    try {
+        for (size_t i = 0; i < probes.size(); ++i) {
+            if (isIndependent[i])
+                finishProbe(productContext, probes[i], resolutions[i]);
+            else
+                resolveProbe(productContext, item, probes[i]);
+        }
+    } catch (const ErrorInfo &) {
+        // Do not wait for the remaining configure scripts to finish on their own.
+        for (const ProbeResolution &resolution : resolutions) {
+            if (resolution.control)
+                resolution.control->cancel();
+        }
+        throw;
+    }
 }
 
 void ModuleLoader::resolveProbe(ProductContext *productContext, Item *parent, Item *probe)
+{
+    ProbeResolution resolution = prepareProbe(productContext, parent, probe);
+    finishProbe(productContext, probe, resolution);
+}
+
+ModuleLoader::ProbeResolution ModuleLoader::prepareProbe(ProductContext *productContext,
+                                                         Item *parent, Item *probe)
 {
     qCDebug(lcModuleLoader) << "Resolving Probe at " << probe->location().toString();
-    ++m_probesEncountered;
-    const QString &probeId = probeGlobalId(probe);
-    if (Q_UNLIKELY(probeId.isEmpty()))
+    ProbeResolution resolution;
+    resolution.probeId = probeGlobalId(probe);
+    if (Q_UNLIKELY(resolution.probeId.isEmpty()))
         throw ErrorInfo(Tr::tr("Probe.id must be set."), probe->location());
-    const JSSourceValueConstPtr configureScript
-            = probe->sourceProperty(StringConstants::configureProperty());
-    QBS_CHECK(configureScript);
-    if (Q_UNLIKELY(configureScript->sourceCode() == StringConstants::undefinedValue()))
+    resolution.configureScript = probe->sourceProperty(StringConstants::configureProperty());
+    QBS_CHECK(resolution.configureScript);
+    if (Q_UNLIKELY(resolution.configureScript->sourceCode() == StringConstants::undefinedValue()))
         throw ErrorInfo(Tr::tr("Probe.configure must be set."), probe->location());
-    typedef std::pair<QString, QScriptValue> ProbeProperty;
-    QList<ProbeProperty> probeBindings;
-    QVariantMap initialProperties;
     for (Item *obj = probe; obj; obj = obj->prototype()) {
         const Item::PropertyMap &props = obj->properties();
         for (auto it = props.cbegin(); it != props.cend(); ++it) {
@@ -3416,67 +3606,288 @@ void ModuleLoader::resolveProbe(ProductContext *productContext, Item *parent, It
             if (name == StringConstants::configureProperty())
                 continue;
             const QScriptValue value = m_evaluator->value(probe, name);
-            probeBindings += ProbeProperty(name, value);
+            resolution.bindings += std::make_pair(name, value);
             if (name != StringConstants::conditionProperty())
-                initialProperties.insert(name, value.toVariant());
+                resolution.initialProperties.insert(name, value.toVariant());
         }
     }
-    ScriptEngine * const engine = m_evaluator->engine();
-    QScriptValue configureScope;
-    const bool condition = m_evaluator->boolValue(probe, StringConstants::conditionProperty());
-    const QString &sourceCode = configureScript->sourceCode().toString();
-    ProbeConstPtr resolvedProbe;
+    resolution.condition = m_evaluator->boolValue(probe, StringConstants::conditionProperty());
+    const QString &sourceCode = resolution.configureScript->sourceCode().toString();
     if (parent->type() == ItemType::Project
             || productContext->name.startsWith(shadowProductPrefix())) {
-        resolvedProbe = findOldProjectProbe(probeId, condition, initialProperties, sourceCode);
+        resolution.resolvedProbe = findOldProjectProbe(resolution.probeId, resolution.condition,
+                                                       resolution.initialProperties, sourceCode);
     } else {
         const QString &uniqueProductName = productContext->uniqueName();
-        resolvedProbe
-                = findOldProductProbe(uniqueProductName, condition, initialProperties, sourceCode);
+        resolution.resolvedProbe = findOldProductProbe(uniqueProductName, resolution.condition,
+                                                       resolution.initialProperties, sourceCode);
     }
-    if (!resolvedProbe) {
-        resolvedProbe = findCurrentProbe(probe->location(), condition, initialProperties);
-        if (resolvedProbe) {
-            qCDebug(lcModuleLoader) << "probe results cached from current run";
-            ++m_probesCachedCurrent;
-        }
+    if (resolution.resolvedProbe) {
+        resolution.cachedFromEarlierRun = true;
     } else {
+        resolution.resolvedProbe = findCurrentProbe(probe->location(), resolution.condition,
+                                                    resolution.initialProperties);
+    }
+    if (!resolution.resolvedProbe && m_probeCache) {
+        resolution.resolvedProbe = m_probeCache->find(probeCacheKey(probe), resolution.condition,
+                                                      resolution.initialProperties, sourceCode);
+        resolution.cachedPersistently = bool(resolution.resolvedProbe);
+    }
+    return resolution;
+}
+
+// Only values that survive the conversion to QVariant unchanged can be passed to another engine.
+// Functions, host objects and instances of classes other than Object and Array cannot.
+static bool isPlainData(const QScriptValue &value, int depth = 0)
+{
+    if (!value.isObject())
+        return true;
+    if (depth > 32 || value.isFunction() || value.isQObject() || value.isQMetaObject()
+            || value.isVariant() || value.isDate() || value.isRegExp() || value.isError()) {
+        return false;
+    }
+    const QScriptValue globalObject = value.engine()->globalObject();
+    const QScriptValue prototype = value.prototype();
+    if (!prototype.strictlyEquals(globalObject.property(QStringLiteral("Object"))
+                                  .property(QStringLiteral("prototype")))
+            && !prototype.strictlyEquals(globalObject.property(QStringLiteral("Array"))
+                                         .property(QStringLiteral("prototype")))) {
+        return false;
+    }
+    QScriptValueIterator it(value);
+    while (it.hasNext()) {
+        it.next();
+        if (!isPlainData(it.value(), depth + 1))
+            return false;
+    }
+    return true;
+}
+
+// The other engine has no access to our items, so a configure script must not mention any
+// of the ids visible in its file.
+static bool refersToIds(const JSSourceValueConstPtr &script)
+{
+    const Item * const idScope = script->file()->idScope();
+    if (!idScope || idScope->properties().empty())
+        return false;
+    QbsQmlJS::Engine engine;
+    QbsQmlJS::Lexer lexer(&engine);
+    lexer.setCode(script->sourceCodeForEvaluation(), 1, false);
+    QbsQmlJS::Parser parser(&engine);
+    if (!parser.parseProgram())
+        return true; // The error will be reported by the main engine.
+    bool found = false;
+    IdentifierSearch idSearch;
+    idSearch.add(QStringLiteral("eval"), &found);
+    for (auto it = idScope->properties().cbegin(); it != idScope->properties().cend(); ++it)
+        idSearch.add(it.key(), &found);
+    idSearch.start(parser.rootNode());
+    return found;
+}
+
+// After conversion to one of these types, a property value is a boolean, a number, a string
+// or an array of strings, so it can be passed back from the other engine unchanged.
+// A property of type var or varList could end up holding anything, e.g. a function.
+static bool hasTransferableType(const PropertyDeclaration &decl)
+{
+    switch (decl.type()) {
+    case PropertyDeclaration::Boolean:
+    case PropertyDeclaration::Integer:
+    case PropertyDeclaration::Path:
+    case PropertyDeclaration::PathList:
+    case PropertyDeclaration::String:
+    case PropertyDeclaration::StringList:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Whether a configure script can run in a separate engine is decided up front, because running
+// it a second time in the main engine would repeat its side effects, such as starting processes
+// or writing files.
+void ModuleLoader::startConfigureScriptInSeparateEngine(Item *probe,
+                                                       ProbeResolution &resolution)
+{
+    if (!resolution.condition || resolution.resolvedProbe)
+        return;
+    if (refersToIds(resolution.configureScript))
+        return;
+    QList<PropertyDeclaration> declarations;
+    QVariantMap bindingValues;
+    for (const auto &b : qAsConst(resolution.bindings)) {
+        const PropertyDeclaration decl = probe->propertyDeclaration(b.first);
+        if (!hasTransferableType(decl) || !isPlainData(b.second))
+            return;
+        declarations << decl;
+        bindingValues.insert(b.first, b.second.toVariant());
+    }
+
+    const FileContextConstPtr file = resolution.configureScript->file();
+    const QString sourceCode = resolution.configureScript->sourceCodeForEvaluation();
+    const CodeLocation location = resolution.configureScript->location();
+    const CodeLocation probeLocation = probe->location();
+    const QProcessEnvironment env = m_parameters.adjustedEnvironment();
+    const auto control = std::make_shared<ConfigureScriptControl>();
+    Logger logger = m_logger;
+    resolution.control = control;
+    resolution.configureScriptResult = std::async(std::launch::async,
+            [file, sourceCode, location, probeLocation, env, declarations, bindingValues,
+             control, logger]() mutable {
+        class FinishedNotifier {
+        public:
+            FinishedNotifier(ConfigureScriptControl &control) : m_control(control) { }
+            ~FinishedNotifier() { m_control.setFinished(); }
+        private:
+            ConfigureScriptControl &m_control;
+        } finishedNotifier(*control);
+
+        ConfigureScriptResult result;
+
+        // The cancelation mechanism of the engine needs an event dispatcher in this thread.
+        QEventLoop eventLoop;
+
+        const std::unique_ptr<ScriptEngine> engine(
+                    ScriptEngine::create(logger, EvalContext::ProbeExecution));
+        if (!control->setEngine(engine.get())) {
+            result.error = ErrorInfo(Tr::tr("Execution canceled"), location);
+            return result;
+        }
+        engine->setEnvironment(env);
+        QScriptValue fileScope = engine->newObject();
+        fileScope.setProperty(StringConstants::filePathGlobalVar(), file->filePath());
+        fileScope.setProperty(StringConstants::pathGlobalVar(), file->dirPath());
+        QScriptValue importScope = engine->newObject();
+        try {
+            setupScriptEngineForFile(engine.get(), file, importScope, ObserveMode::Enabled);
+        } catch (const ErrorInfo &e) {
+            control->setEngine(nullptr);
+            result.error = e;
+            return result;
+        }
+        QScriptValue configureScope = engine->newObject();
+        for (auto it = bindingValues.cbegin(); it != bindingValues.cend(); ++it)
+            configureScope.setProperty(it.key(), engine->toScriptValue(it.value()));
+        engine->currentContext()->pushScope(fileScope);
+        engine->currentContext()->pushScope(importScope);
+        engine->currentContext()->pushScope(configureScope);
+        engine->clearRequestedProperties();
+        const QScriptValue sv = engine->evaluate(sourceCode);
+        engine->currentContext()->popScope();
+        engine->currentContext()->popScope();
+        engine->currentContext()->popScope();
+        control->setEngine(nullptr);
+        if (Q_UNLIKELY(engine->hasErrorOrException(sv))) {
+            result.error = engine->lastError(sv, location);
+            return result;
+        }
+
+        // The same conversion that finishProbe() does for scripts run in the main engine.
+        for (const PropertyDeclaration &decl : qAsConst(declarations)) {
+            QScriptValue value = configureScope.property(decl.name());
+            EvaluatorScriptClass::convertToPropertyType(decl, probeLocation, value);
+            if (Q_UNLIKELY(engine->hasErrorOrException(value))) {
+                result.error = engine->lastError(value);
+                return result;
+            }
+            result.properties.insert(decl.name(), value.toVariant());
+        }
+        result.importedFilesUsed = engine->importedFilesUsedInScript();
+        result.requestedEnvironmentVariables = engine->requestedEnvironmentVariables();
+        result.wholeEnvironmentRequested = engine->wholeEnvironmentRequested();
+        return result;
+    });
+}
+
+ModuleLoader::ConfigureScriptResult ModuleLoader::waitForConfigureScript(
+        ProbeResolution &resolution)
+{
+    QEventLoop loop;
+
+    // As in Loader::loadProject(), the progress observer has to be asked for cancelation.
+    QTimer cancelationTimer;
+    if (m_progressObserver) {
+        QObject::connect(&cancelationTimer, &QTimer::timeout, [this, &resolution]() {
+            if (m_progressObserver->canceled())
+                resolution.control->cancel();
+        });
+        cancelationTimer.start(1000);
+    }
+    if (resolution.control->setWaitingLoop(&loop))
+        loop.exec();
+    resolution.control->setWaitingLoop(nullptr);
+    ConfigureScriptResult result = resolution.configureScriptResult.get();
+    checkCancelation();
+    return result;
+}
+
+void ModuleLoader::finishProbe(ProductContext *productContext, Item *probe,
+                               ProbeResolution &resolution)
+{
+    ++m_probesEncountered;
+    ProbeConstPtr resolvedProbe = resolution.resolvedProbe;
+    if (resolvedProbe && resolution.cachedFromEarlierRun) {
         qCDebug(lcModuleLoader) << "probe results cached from earlier run";
         ++m_probesCachedOld;
+    } else if (resolvedProbe && resolution.cachedPersistently) {
+        qCDebug(lcModuleLoader) << "probe results cached from earlier configuration";
+        ++m_probesCachedPersistently;
+    } else if (resolvedProbe) {
+        qCDebug(lcModuleLoader) << "probe results cached from current run";
+        ++m_probesCachedCurrent;
     }
+    ScriptEngine * const engine = m_evaluator->engine();
+    const JSSourceValueConstPtr &configureScript = resolution.configureScript;
+    QScriptValue configureScope;
     std::vector<QString> importedFilesUsedInConfigure;
-    if (!condition) {
+    Set<QString> requestedEnvironmentVariables;
+    bool wholeEnvironmentRequested = false;
+    if (!resolution.condition) {
         qCDebug(lcModuleLoader) << "Probe disabled; skipping";
     } else if (!resolvedProbe) {
         ++m_probesRun;
         qCDebug(lcModuleLoader) << "configure script needs to run";
-        const Evaluator::FileContextScopes fileCtxScopes
-                = m_evaluator->fileContextScopes(configureScript->file());
-        engine->currentContext()->pushScope(fileCtxScopes.fileScope);
-        engine->currentContext()->pushScope(fileCtxScopes.importScope);
-        configureScope = engine->newObject();
-        for (const ProbeProperty &b : qAsConst(probeBindings))
-            configureScope.setProperty(b.first, b.second);
-        engine->currentContext()->pushScope(configureScope);
-        engine->clearRequestedProperties();
-        QScriptValue sv = engine->evaluate(configureScript->sourceCodeForEvaluation());
-        engine->currentContext()->popScope();
-        engine->currentContext()->popScope();
-        engine->currentContext()->popScope();
-        engine->releaseResourcesOfScriptObjects();
-        if (Q_UNLIKELY(engine->hasErrorOrException(sv)))
-            throw ErrorInfo(engine->lastErrorString(sv), configureScript->location());
-        importedFilesUsedInConfigure = engine->importedFilesUsedInScript();
+        if (resolution.configureScriptResult.valid()) {
+            const ConfigureScriptResult result = waitForConfigureScript(resolution);
+            if (Q_UNLIKELY(result.error.hasError()))
+                throw result.error;
+            configureScope = engine->newObject();
+            for (auto it = result.properties.cbegin(); it != result.properties.cend(); ++it)
+                configureScope.setProperty(it.key(), engine->toScriptValue(it.value()));
+            importedFilesUsedInConfigure = result.importedFilesUsed;
+            requestedEnvironmentVariables = result.requestedEnvironmentVariables;
+            wholeEnvironmentRequested = result.wholeEnvironmentRequested;
+        } else {
+            const Evaluator::FileContextScopes fileCtxScopes
+                    = m_evaluator->fileContextScopes(configureScript->file());
+            engine->currentContext()->pushScope(fileCtxScopes.fileScope);
+            engine->currentContext()->pushScope(fileCtxScopes.importScope);
+            configureScope = engine->newObject();
+            for (const auto &b : qAsConst(resolution.bindings))
+                configureScope.setProperty(b.first, b.second);
+            engine->currentContext()->pushScope(configureScope);
+            engine->clearRequestedProperties();
+            QScriptValue sv = engine->evaluate(configureScript->sourceCodeForEvaluation());
+            engine->currentContext()->popScope();
+            engine->currentContext()->popScope();
+            engine->currentContext()->popScope();
+            engine->releaseResourcesOfScriptObjects();
+            if (Q_UNLIKELY(engine->hasErrorOrException(sv)))
+                throw engine->lastError(sv, configureScript->location());
+            importedFilesUsedInConfigure = engine->importedFilesUsedInScript();
+            requestedEnvironmentVariables = engine->requestedEnvironmentVariables();
+            wholeEnvironmentRequested = engine->wholeEnvironmentRequested();
+        }
     } else {
         importedFilesUsedInConfigure = resolvedProbe->importedFilesUsed();
     }
     QVariantMap properties;
-    for (const ProbeProperty &b : qAsConst(probeBindings)) {
+    for (const auto &b : qAsConst(resolution.bindings)) {
         QVariant newValue;
         if (resolvedProbe) {
             newValue = resolvedProbe->properties().value(b.first);
         } else {
-            if (condition) {
+            if (resolution.condition) {
                 QScriptValue v = configureScope.property(b.first);
                 m_evaluator->convertToPropertyType(probe->propertyDeclaration(
                                                    b.first), probe->location(), v);
@@ -3484,19 +3895,25 @@ void ModuleLoader::resolveProbe(ProductContext *productContext, Item *parent, It
                     throw ErrorInfo(engine->lastError(v));
                 newValue = v.toVariant();
             } else {
-                newValue = initialProperties.value(b.first);
+                newValue = resolution.initialProperties.value(b.first);
             }
         }
         if (newValue != b.second.toVariant())
             probe->setProperty(b.first, VariantValue::create(newValue));
-        if (!resolvedProbe)
+        if (!resolvedProbe || resolution.cachedPersistently)
             properties.insert(b.first, newValue);
     }
-    if (!resolvedProbe) {
-        resolvedProbe = Probe::create(probeId, probe->location(), condition,
-                                      sourceCode, properties, initialProperties,
+    if (!resolvedProbe || resolution.cachedPersistently) {
+        // Cached entries might come from a different source location.
+        const bool isNew = !resolvedProbe;
+        resolvedProbe = Probe::create(resolution.probeId, probe->location(), resolution.condition,
+                                      configureScript->sourceCode().toString(), properties,
+                                      resolution.initialProperties,
                                       importedFilesUsedInConfigure);
         m_currentProbes[probe->location()] << resolvedProbe;
+        if (isNew && resolution.condition && m_probeCache)
+            m_probeCache->insert(probeCacheKey(probe), resolvedProbe,
+                                 requestedEnvironmentVariables, wholeEnvironmentRequested);
     }
     productContext->info.probes << resolvedProbe;
 }
@@ -3588,12 +4005,22 @@ Item *ModuleLoader::wrapInProjectIfNecessary(Item *item)
 QString ModuleLoader::findExistingModulePath(const QString &searchPath,
         const QualifiedId &moduleName)
 {
+    // Every product looks up its modules in the same search paths, and the file system
+    // checks below are not cheap, so remember the results for the whole resolve.
+    const auto cacheKey = std::make_pair(searchPath, moduleName.toString());
+    const auto it = m_existingModulePathCache.constFind(cacheKey);
+    if (it != m_existingModulePathCache.constEnd())
+        return it.value();
+
     QString dirPath = searchPath + QStringLiteral("/modules");
     for (const QString &moduleNamePart : moduleName) {
         dirPath = FileInfo::resolvePath(dirPath, moduleNamePart);
-        if (!FileInfo::exists(dirPath) || !FileInfo::isFileCaseCorrect(dirPath))
-            return QString();
+        if (!FileInfo::exists(dirPath) || !FileInfo::isFileCaseCorrect(dirPath)) {
+            dirPath.clear();
+            break;
+        }
     }
+    m_existingModulePathCache.insert(cacheKey, dirPath);
     return dirPath;
 }
 
@@ -3626,29 +4053,32 @@ void ModuleLoader::overrideItemProperties(Item *item, const QString &buildConfig
     }
 }
 
-void ModuleLoader::collectAllModules(Item *item, std::vector<Item::Module> *modules)
+void ModuleLoader::collectAllModules(Item *item, std::vector<Item::Module> *modules,
+                                     QHash<QualifiedId, size_t> *moduleIndexes)
 {
     for (const Item::Module &m : item->modules()) {
         if (moduleRepresentsDisabledProduct(m))
             m.item->removeModules();
-        auto it = std::find_if(modules->begin(), modules->end(),
-                               [m] (const Item::Module &m2) { return m.name == m2.name; });
-        if (it != modules->end()) {
+        const auto it = moduleIndexes->constFind(m.name);
+        if (it != moduleIndexes->constEnd()) {
             // If a module is required somewhere, it is required in the top-level item.
+            Item::Module &collectedModule = modules->at(it.value());
             if (m.required)
-                it->required = true;
-            it->versionRange.narrowDown(m.versionRange);
+                collectedModule.required = true;
+            collectedModule.versionRange.narrowDown(m.versionRange);
             continue;
         }
+        moduleIndexes->insert(m.name, modules->size());
         modules->push_back(m);
-        collectAllModules(m.item, modules);
+        collectAllModules(m.item, modules, moduleIndexes);
     }
 }
 
 std::vector<Item::Module> ModuleLoader::allModules(Item *item)
 {
     std::vector<Item::Module> lst;
-    collectAllModules(item, &lst);
+    QHash<QualifiedId, size_t> moduleIndexes;
+    collectAllModules(item, &lst, &moduleIndexes);
     return lst;
 }
 
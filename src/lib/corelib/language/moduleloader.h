@@ -71,6 +71,7 @@ namespace Internal {
 class Evaluator;
 class Item;
 class ItemReader;
+class ProbeCache;
 class ProgressObserver;
 class QualifiedId;
 
@@ -320,15 +321,20 @@ private:
             const QualifiedId &moduleName, ProductModuleInfo *productModuleInfo);
     void createChildInstances(Item *instance, Item *prototype,
                               QHash<Item *, Item *> *prototypeInstanceMap) const;
+    struct ConfigureScriptResult;
+    struct ProbeResolution;
     void resolveProbes(ProductContext *productContext, Item *item);
     void resolveProbe(ProductContext *productContext, Item *parent, Item *probe);
+    ProbeResolution prepareProbe(ProductContext *productContext, Item *parent, Item *probe);
+    void startConfigureScriptInSeparateEngine(Item *probe, ProbeResolution &resolution);
+    ConfigureScriptResult waitForConfigureScript(ProbeResolution &resolution);
+    void finishProbe(ProductContext *productContext, Item *probe, ProbeResolution &resolution);
     void checkCancelation() const;
     bool checkItemCondition(Item *item, Item *itemToDisable = nullptr);
     QStringList readExtraSearchPaths(Item *item, bool *wasSet = nullptr);
     void copyProperties(const Item *sourceProject, Item *targetProject);
     Item *wrapInProjectIfNecessary(Item *item);
-    static QString findExistingModulePath(const QString &searchPath,
-            const QualifiedId &moduleName);
+    QString findExistingModulePath(const QString &searchPath, const QualifiedId &moduleName);
     static void setScopeForDescendants(Item *item, Item *scope);
     void overrideItemProperties(Item *item, const QString &buildConfigKey,
                                 const QVariantMap &buildConfig);
@@ -349,6 +355,7 @@ private:
                                       const QString &sourceCode) const;
     ProbeConstPtr findCurrentProbe(const CodeLocation &location, bool condition,
                                    const QVariantMap &initialProperties) const;
+    QString probeCacheKey(Item *probe) const;
 
     enum class CompareScript { No, Yes };
     bool probeMatches(const ProbeConstPtr &probe, bool condition,
@@ -373,8 +380,10 @@ private:
     void setSearchPathsForProduct(ProductContext *product);
 
     Item::Modules modulesSortedByDependency(const Item *productItem);
-    void createSortedModuleList(const Item::Module &parentModule, Item::Modules &modules);
-    void collectAllModules(Item *item, std::vector<Item::Module> *modules);
+    void createSortedModuleList(const Item::Module &parentModule, Item::Modules &modules,
+                                QualifiedIdSet &seenModules);
+    void collectAllModules(Item *item, std::vector<Item::Module> *modules,
+                           QHash<QualifiedId, size_t> *moduleIndexes);
     std::vector<Item::Module> allModules(Item *item);
     bool moduleRepresentsDisabledProduct(const Item::Module &module);
 
@@ -388,6 +397,10 @@ private:
     Evaluator *m_evaluator;
     QMap<QString, QStringList> m_moduleDirListCache;
 
+    // The keys are search paths and module names, the values are the module directories
+    // (empty if the module is not present in the respective search path).
+    QHash<std::pair<QString, QString>, QString> m_existingModulePathCache;
+
     // The keys are file paths, the values are module prototype items accompanied by a profile.
     std::unordered_map<QString, std::vector<std::pair<Item *, QString>>> m_modulePrototypes;
 
@@ -417,6 +430,7 @@ private:
     QHash<QString, std::vector<ProbeConstPtr>> m_oldProductProbes;
     FileTime m_lastResolveTime;
     QHash<CodeLocation, QList<ProbeConstPtr>> m_currentProbes;
+    std::unique_ptr<ProbeCache> m_probeCache;
     QVariantMap m_storedProfiles;
     QVariantMap m_localProfiles;
     std::multimap<QString, const ProductContext *> m_productsByName;
@@ -440,6 +454,7 @@ private:
     quint64 m_probesRun;
     quint64 m_probesCachedCurrent;
     quint64 m_probesCachedOld;
+    quint64 m_probesCachedPersistently;
     Set<QString> m_projectNamesUsedInOverrides;
     Set<QString> m_productNamesUsedInOverrides;
     Set<QString> m_disabledProjects;
@@ -0,0 +1,262 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "probecache.h"
+
+#include "language.h"
+
+#include <logging/categories.h>
+#include <tools/error.h>
+#include <tools/fileinfo.h>
+#include <tools/set.h>
+
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qlockfile.h>
+
+#include <algorithm>
+
+namespace qbs {
+namespace Internal {
+
+// Older entries for the same probe are dropped, so the cache file does not grow without bounds
+// when switching between many configurations.
+static const size_t MaxEntriesPerProbe = 16;
+
+static QString fingerprint(QStringList entries)
+{
+    std::sort(entries.begin(), entries.end());
+    return QString::fromLatin1(QCryptographicHash::hash(entries.join(QLatin1Char('\n')).toUtf8(),
+                                                        QCryptographicHash::Sha1).toHex());
+}
+
+static QString environmentFingerprint(const QProcessEnvironment &environment)
+{
+    return fingerprint(environment.toStringList());
+}
+
+// Unset variables are distinguished from empty ones.
+static QString environmentFingerprint(const QProcessEnvironment &environment,
+                                      const QStringList &variables)
+{
+    QStringList entries;
+    for (const QString &name : variables) {
+        entries << (environment.contains(name)
+                    ? name + QLatin1Char('=') + environment.value(name) : name);
+    }
+    return fingerprint(entries);
+}
+
+// Probes typically report the locations of the tools and files they found. These are the
+// best approximation we have of what the configure script looked at.
+static void collectFilePaths(const QVariant &value, Set<QString> &filePaths)
+{
+    switch (static_cast<QMetaType::Type>(value.type())) {
+    case QMetaType::QString: {
+        const QString s = value.toString();
+        if (FileInfo::isAbsolute(s) && FileInfo::exists(s))
+            filePaths.insert(QDir::cleanPath(s));
+        break;
+    }
+    case QMetaType::QStringList:
+    case QMetaType::QVariantList:
+        for (const QVariant &v : value.toList())
+            collectFilePaths(v, filePaths);
+        break;
+    case QMetaType::QVariantMap: {
+        const QVariantMap map = value.toMap();
+        for (auto it = map.cbegin(); it != map.cend(); ++it)
+            collectFilePaths(it.value(), filePaths);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+static bool hasSameKey(const QString &key1, const ProbeConstPtr &p1,
+                       const QString &key2, const ProbeConstPtr &p2)
+{
+    return key1 == key2
+            && p1->condition() == p2->condition()
+            && p1->configureScript() == p2->configureScript()
+            && p1->initialProperties() == p2->initialProperties();
+}
+
+bool ProbeCache::Entry::hasSameEnvironment(const Entry &other) const
+{
+    return usesWholeEnvironment == other.usesWholeEnvironment
+            && environmentVariables == other.environmentVariables
+            && environmentFingerprint == other.environmentFingerprint;
+}
+
+bool ProbeCache::Entry::isUpToDate() const
+{
+    return std::all_of(fileFingerprints.cbegin(), fileFingerprints.cend(),
+                       [](const std::pair<QString, FileTime> &fingerprint) {
+        return FileInfo(fingerprint.first).lastModified() == fingerprint.second;
+    });
+}
+
+ProbeCache::ProbeCache(const QString &filePath, const QProcessEnvironment &environment,
+                       Logger &logger)
+    : m_filePath(filePath)
+    , m_environment(environment)
+    , m_environmentFingerprint(environmentFingerprint(environment))
+    , m_logger(logger)
+{
+    for (const Entry &entry : loadEntries())
+        m_entries[entry.key].push_back(entry);
+}
+
+QString ProbeCache::filePathFromEnvironment()
+{
+    const QString dirPath = QString::fromLocal8Bit(qgetenv("QBS_PROBE_CACHE_DIR"));
+    if (dirPath.isEmpty())
+        return QString();
+    return QDir(dirPath).absoluteFilePath(QStringLiteral("probes.cache"));
+}
+
+ProbeConstPtr ProbeCache::find(const QString &key, bool condition,
+                               const QVariantMap &initialProperties,
+                               const QString &configureScript) const
+{
+    const auto it = m_entries.constFind(key);
+    if (it == m_entries.cend())
+        return ProbeConstPtr();
+    for (const Entry &entry : it.value()) {
+        if (entry.probe->condition() == condition
+                && entry.environmentFingerprint == (entry.usesWholeEnvironment
+                    ? m_environmentFingerprint
+                    : environmentFingerprint(m_environment, entry.environmentVariables))
+                && entry.probe->configureScript() == configureScript
+                && entry.probe->initialProperties() == initialProperties
+                && entry.isUpToDate()) {
+            return entry.probe;
+        }
+    }
+    return ProbeConstPtr();
+}
+
+void ProbeCache::insert(const QString &key, const ProbeConstPtr &probe,
+                        const Set<QString> &environmentVariables, bool usesWholeEnvironment)
+{
+    Entry entry;
+    entry.key = key;
+    entry.probe = probe;
+    entry.usesWholeEnvironment = usesWholeEnvironment;
+    if (usesWholeEnvironment) {
+        entry.environmentFingerprint = m_environmentFingerprint;
+    } else {
+        entry.environmentVariables = environmentVariables.toStringList();
+        entry.environmentFingerprint = environmentFingerprint(m_environment,
+                                                              entry.environmentVariables);
+    }
+    Set<QString> filePaths;
+    for (const QString &filePath : probe->importedFilesUsed())
+        filePaths.insert(filePath);
+    collectFilePaths(probe->properties(), filePaths);
+    collectFilePaths(probe->initialProperties(), filePaths);
+    for (const QString &filePath : filePaths)
+        entry.fileFingerprints.emplace_back(filePath, FileInfo(filePath).lastModified());
+    addEntry(entry);
+    m_newEntries.push_back(entry);
+}
+
+void ProbeCache::store()
+{
+    if (m_newEntries.empty())
+        return;
+
+    // Other processes might have added entries since we read the file, and they might
+    // want to store their own entries at the same time as we do.
+    QDir().mkpath(FileInfo::path(m_filePath));
+    QLockFile lockFile(m_filePath + QStringLiteral(".lock"));
+    if (!lockFile.tryLock(10000)) {
+        qCDebug(lcModuleLoader) << "cannot lock probe cache:" << lockFile.error();
+        return;
+    }
+    m_entries.clear();
+    for (const Entry &entry : loadEntries())
+        addEntry(entry);
+    for (const Entry &entry : m_newEntries)
+        addEntry(entry);
+    m_newEntries.clear();
+
+    std::vector<Entry> entries;
+    for (const std::vector<Entry> &entriesForProbe : qAsConst(m_entries))
+        entries.insert(entries.end(), entriesForProbe.cbegin(), entriesForProbe.cend());
+    try {
+        PersistentPool pool(m_logger);
+        pool.setupWriteStream(m_filePath);
+        pool.store(entries);
+        pool.finalizeWriteStream();
+    } catch (const ErrorInfo &e) {
+        qCDebug(lcModuleLoader) << "cannot store probe cache:" << e.toString();
+    }
+}
+
+std::vector<ProbeCache::Entry> ProbeCache::loadEntries() const
+{
+    if (!FileInfo::exists(m_filePath))
+        return std::vector<Entry>();
+    try {
+        PersistentPool pool(m_logger);
+        pool.load(m_filePath);
+        return pool.load<std::vector<Entry>>();
+    } catch (const ErrorInfo &e) {
+        // Written by an incompatible version of qbs or otherwise unusable; will be overwritten.
+        qCDebug(lcModuleLoader) << "ignoring probe cache:" << e.toString();
+        return std::vector<Entry>();
+    }
+}
+
+void ProbeCache::addEntry(const Entry &entry)
+{
+    std::vector<Entry> &entries = m_entries[entry.key];
+    entries.erase(std::remove_if(entries.begin(), entries.end(), [&entry](const Entry &e) {
+        return e.hasSameEnvironment(entry) && hasSameKey(e.key, e.probe, entry.key, entry.probe);
+    }), entries.end());
+    entries.push_back(entry);
+    if (entries.size() > MaxEntriesPerProbe)
+        entries.erase(entries.begin(), entries.end() - MaxEntriesPerProbe);
+}
+
+} // namespace Internal
+} // namespace qbs
@@ -0,0 +1,120 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_PROBECACHE_H
+#define QBS_PROBECACHE_H
+
+#include "forward_decls.h"
+
+#include <tools/filetime.h>
+#include <tools/persistence.h>
+#include <tools/set.h>
+
+#include <QtCore/qhash.h>
+#include <QtCore/qprocess.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qvariant.h>
+
+#include <utility>
+#include <vector>
+
+namespace qbs {
+namespace Internal {
+class Logger;
+
+// Keeps the results of configure scripts across build directories. An entry is only
+// handed out again if the environment variables the configure script read and all files
+// the probe is known to depend on are unchanged.
+class ProbeCache
+{
+public:
+    ProbeCache(const QString &filePath, const QProcessEnvironment &environment,
+               Logger &logger);
+
+    static QString filePathFromEnvironment();
+
+    // The key is the probe's global id, except that probes in the project's own files are
+    // identified relative to the project directory, so copies of the project elsewhere
+    // share the entries.
+    ProbeConstPtr find(const QString &key, bool condition,
+                       const QVariantMap &initialProperties, const QString &configureScript) const;
+    void insert(const QString &key, const ProbeConstPtr &probe,
+                const Set<QString> &environmentVariables, bool usesWholeEnvironment);
+    void store();
+
+private:
+    struct Entry
+    {
+        QString key;
+        ProbeConstPtr probe;
+
+        // Not used if the configure script might have seen the whole environment,
+        // e.g. because it called Environment.currentEnv().
+        QStringList environmentVariables;
+        bool usesWholeEnvironment = false;
+
+        QString environmentFingerprint;
+        std::vector<std::pair<QString, FileTime>> fileFingerprints;
+
+        bool hasSameEnvironment(const Entry &other) const;
+        bool isUpToDate() const;
+
+        template<PersistentPool::OpType opType> void completeSerializationOp(PersistentPool &pool)
+        {
+            pool.serializationOp<opType>(key, probe, environmentVariables, usesWholeEnvironment,
+                                         environmentFingerprint, fileFingerprints);
+        }
+    };
+
+    std::vector<Entry> loadEntries() const;
+    void addEntry(const Entry &entry);
+
+    const QString m_filePath;
+    const QProcessEnvironment m_environment;
+    const QString m_environmentFingerprint;
+    Logger &m_logger;
+    QHash<QString, std::vector<Entry>> m_entries;
+    std::vector<Entry> m_newEntries;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_PROBECACHE_H
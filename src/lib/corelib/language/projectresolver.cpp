@@ -684,8 +684,9 @@ QVariantMap ProjectResolver::resolveAdditionalModuleProperties(const Item *group
         QVariantMap reusableValues = modulesMap.value(fullModName).toMap();
         for (const QString &prop : qAsConst(propsForModule))
             reusableValues.remove(prop);
-        modulesMap.insert(fullModName,
-                          evaluateProperties(module.item, module.item, reusableValues, true, true));
+        modulesMap.insert(fullModName, m_propertyMapInterner.intern(
+                              evaluateProperties(module.item, module.item, reusableValues,
+                                                 true, true)));
     }
     m_evaluator->clearPathPropertiesBaseDir();
     return modulesMap;
@@ -1281,7 +1282,7 @@ void ProjectResolver::resolveRuleArtifact(const RulePtr &rule, Item *item)
 
     QualifiedIdSet seenBindings;
     for (Item *obj = item; obj; obj = obj->prototype()) {
-        for (QMap<QString, ValuePtr>::const_iterator it = obj->properties().constBegin();
+        for (Item::PropertyMap::const_iterator it = obj->properties().constBegin();
              it != obj->properties().constEnd(); ++it)
         {
             if (it.value()->type() != Value::ItemValueType)
@@ -1298,7 +1299,7 @@ void ProjectResolver::resolveRuleArtifactBinding(const RuleArtifactPtr &ruleArti
                                                  const QStringList &namePrefix,
                                                  QualifiedIdSet *seenBindings)
 {
-    for (QMap<QString, ValuePtr>::const_iterator it = item->properties().constBegin();
+    for (Item::PropertyMap::const_iterator it = item->properties().constBegin();
          it != item->properties().constEnd(); ++it)
     {
         const QStringList name = QStringList(namePrefix) << it.key();
@@ -1699,7 +1700,8 @@ QVariantMap ProjectResolver::evaluateModuleValues(Item *item, bool lookupPrototy
         if (!module.item->isPresentModule())
             continue;
         const QString fullName = module.name.toString();
-        moduleValues[fullName] = evaluateProperties(module.item, lookupPrototype, true);
+        moduleValues[fullName] = m_propertyMapInterner.intern(
+                    evaluateProperties(module.item, lookupPrototype, true));
     }
 
     return moduleValues;
@@ -1717,14 +1719,18 @@ QVariantMap ProjectResolver::evaluateProperties(const Item *item, const Item *pr
     AccumulatingTimer propEvalTimer(m_setupParams.logElapsedTime()
                                     ? &m_elapsedTimeAllPropEval : nullptr);
     QVariantMap result = tmplt;
-    for (QMap<QString, ValuePtr>::const_iterator it = propertiesContainer->properties().begin();
-         it != propertiesContainer->properties().end(); ++it) {
-        checkCancelation();
-        evaluateProperty(item, it.key(), it.value(), result, checkErrors);
+
+    // Walk the prototype chain in a loop rather than recursively, so that the result map
+    // is not copied once per prototype level.
+    for (const Item *container = propertiesContainer; container;
+         container = lookupPrototype ? container->prototype() : nullptr) {
+        for (Item::PropertyMap::const_iterator it = container->properties().begin();
+             it != container->properties().end(); ++it) {
+            checkCancelation();
+            evaluateProperty(item, it.key(), it.value(), result, checkErrors);
+        }
     }
-    return lookupPrototype && propertiesContainer->prototype()
-            ? evaluateProperties(item, propertiesContainer->prototype(), result, true, checkErrors)
-            : result;
+    return result;
 }
 
 void ProjectResolver::evaluateProperty(const Item *item, const QString &propName,
@@ -1758,13 +1764,14 @@ void ProjectResolver::evaluateProperty(const Item *item, const QString &propName
             v = scriptValue.toString();
         } else {
             v = scriptValue.toVariant();
-            QVariantMap m = v.toMap();
-            if (m.contains(StringConstants::importScopeNamePropertyInternal())) {
-                QVariantMap tmp = m;
-                m = scriptValue.prototype().toVariant().toMap();
-                for (auto it = tmp.begin(); it != tmp.end(); ++it)
-                    m.insert(it.key(), it.value());
-                v = m;
+            if (v.type() == QVariant::Map) {
+                const QVariantMap tmp = v.toMap();
+                if (tmp.contains(StringConstants::importScopeNamePropertyInternal())) {
+                    QVariantMap m = scriptValue.prototype().toVariant().toMap();
+                    for (auto it = tmp.begin(); it != tmp.end(); ++it)
+                        m.insert(it.key(), it.value());
+                    v = m;
+                }
             }
         }
 
@@ -43,6 +43,7 @@
 #include "filetags.h"
 #include "itemtype.h"
 #include "moduleloader.h"
+#include "propertymapinternal.h"
 #include "qualifiedid.h"
 
 #include <logging/logger.h>
@@ -189,6 +190,7 @@ private:
     Set<CodeLocation> m_groupLocationWarnings;
     std::vector<std::pair<ResolvedProductPtr, Item *>> m_productExportInfo;
     std::vector<ErrorInfo> m_queuedErrors;
+    PropertyMapInterner m_propertyMapInterner;
     qint64 m_elapsedTimeModPropEval;
     qint64 m_elapsedTimeAllPropEval;
     qint64 m_elapsedTimeGroups;
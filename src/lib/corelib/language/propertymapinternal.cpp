@@ -43,6 +43,8 @@
 #include <tools/scripttools.h>
 #include <tools/stringconstants.h>
 
+#include <algorithm>
+
 namespace qbs {
 namespace Internal {
 
@@ -87,6 +89,82 @@ void PropertyMapInternal::setValue(const QVariantMap &map)
     m_value = map;
 }
 
+static inline uint combineHash(uint h1, uint h2)
+{
+    return ((h1 << 16) | (h1 >> 16)) ^ h2;
+}
+
+static uint variantHash(const QVariant &v)
+{
+    const uint typeHash = qHash(v.userType());
+    switch (v.userType()) {
+    case QMetaType::Bool:
+        return combineHash(typeHash, qHash(v.toBool()));
+    case QMetaType::Int:
+        return combineHash(typeHash, qHash(v.toInt()));
+    case QMetaType::QString:
+        return combineHash(typeHash, qHash(v.toString()));
+    case QMetaType::QStringList:
+        return combineHash(typeHash, qHash(v.toStringList()));
+    case QMetaType::QVariantList: {
+        uint h = typeHash;
+        for (const QVariant &element : v.toList())
+            h = combineHash(h, variantHash(element));
+        return h;
+    }
+    case QMetaType::QVariantMap: {
+        uint h = typeHash;
+        const QVariantMap map = v.toMap();
+        for (auto it = map.cbegin(); it != map.cend(); ++it)
+            h = combineHash(h, combineHash(qHash(it.key()), variantHash(it.value())));
+        return h;
+    }
+    default:
+        return typeHash;
+    }
+}
+
+// QVariant::operator== converts between types, e.g. it considers 1 and "1" to be equal.
+// Values of interned maps must not change their type, so be stricter here.
+static bool variantsAreIdentical(const QVariant &v1, const QVariant &v2)
+{
+    if (v1.userType() != v2.userType())
+        return false;
+    switch (v1.userType()) {
+    case QMetaType::QVariantList: {
+        const QVariantList l1 = v1.toList();
+        const QVariantList l2 = v2.toList();
+        return l1.size() == l2.size()
+                && std::equal(l1.cbegin(), l1.cend(), l2.cbegin(), variantsAreIdentical);
+    }
+    case QMetaType::QVariantMap: {
+        const QVariantMap m1 = v1.toMap();
+        const QVariantMap m2 = v2.toMap();
+        if (m1.size() != m2.size())
+            return false;
+        for (auto it1 = m1.cbegin(), it2 = m2.cbegin(); it1 != m1.cend(); ++it1, ++it2) {
+            if (it1.key() != it2.key() || !variantsAreIdentical(it1.value(), it2.value()))
+                return false;
+        }
+        return true;
+    }
+    default:
+        return v1 == v2;
+    }
+}
+
+QVariantMap PropertyMapInterner::intern(const QVariantMap &map)
+{
+    const QVariant mapAsVariant(map);
+    std::vector<QVariantMap> &candidates = m_maps[variantHash(mapAsVariant)];
+    for (const QVariantMap &candidate : candidates) {
+        if (variantsAreIdentical(candidate, mapAsVariant))
+            return candidate;
+    }
+    candidates.push_back(map);
+    return map;
+}
+
 QVariant moduleProperty(const QVariantMap &properties, const QString &moduleName,
                         const QString &key, bool *isPresent)
 {
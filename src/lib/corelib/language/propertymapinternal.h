@@ -43,8 +43,11 @@
 #include "forward_decls.h"
 #include <tools/persistence.h>
 #include <tools/qbs_export.h>
+#include <QtCore/qhash.h>
 #include <QtCore/qvariant.h>
 
+#include <vector>
+
 namespace qbs {
 namespace Internal {
 
@@ -77,9 +80,21 @@ private:
 
 inline bool operator==(const PropertyMapInternal &lhs, const PropertyMapInternal &rhs)
 {
-    return lhs.m_value == rhs.m_value;
+    return &lhs == &rhs || lhs.m_value == rhs.m_value;
 }
 
+// Hands out a single shared instance for all property maps with equal content.
+// Products typically have lots of modules with identical property values (e.g. qbs or cpp),
+// so this saves memory, and the build graph stores each of these maps only once.
+class QBS_AUTOTEST_EXPORT PropertyMapInterner
+{
+public:
+    QVariantMap intern(const QVariantMap &map);
+
+private:
+    QHash<uint, std::vector<QVariantMap>> m_maps;
+};
+
 QVariant QBS_AUTOTEST_EXPORT moduleProperty(const QVariantMap &properties,
                                             const QString &moduleName,
                                             const QString &key, bool *isPresent = nullptr);
@@ -58,14 +58,13 @@
 
 #include <QtCore/qdebug.h>
 #include <QtCore/qdiriterator.h>
-#include <QtCore/qfile.h>
 #include <QtCore/qfileinfo.h>
-#include <QtCore/qtextstream.h>
 #include <QtCore/qtimer.h>
 
 #include <QtScript/qscriptclass.h>
 #include <QtScript/qscriptvalueiterator.h>
 
+#include <algorithm>
 #include <functional>
 #include <set>
 #include <utility>
@@ -134,6 +133,11 @@ ScriptEngine::~ScriptEngine()
     if (m_elapsedTimeImporting != -1) {
         m_logger.qbsLog(LoggerInfo, true) << Tr::tr("Setting up imports took %1.")
                                              .arg(elapsedTimeString(m_elapsedTimeImporting));
+        if (m_programCacheHits + m_programCacheMisses > 0) {
+            m_logger.qbsLog(LoggerInfo, true)
+                    << Tr::tr("%1 scripts compiled, %2 re-used from program cache.")
+                       .arg(m_programCacheMisses).arg(m_programCacheHits);
+        }
     }
     delete m_modulePropertyScriptClass;
     delete m_productPropertyScriptClass;
@@ -276,16 +280,91 @@ void ScriptEngine::enableProfiling(bool enable)
     m_elapsedTimeImporting = enable ? 0 : -1;
 }
 
-void ScriptEngine::addToPropertyCache(const QString &moduleName, const QString &propertyName,
-        const PropertyMapConstPtr &propertyMap, const QVariant &value)
-{
-    m_propertyCache.insert(PropertyCacheKey(moduleName, propertyName, propertyMap), value);
+QScriptValue ScriptEngine::addToPropertyCache(const QString &moduleName,
+        const QString &propertyName, const PropertyMapConstPtr &propertyMap,
+        const QVariant &value)
+{
+    PropertyCacheEntry entry;
+    entry.value = value;
+    const QScriptValue scriptValue = toScriptValue(value);
+    if (!scriptValue.isObject()) {
+        entry.scriptValue = scriptValue;
+    } else if (scriptValue.isArray()) {
+        const quint32 length = scriptValue.property(StringConstants::lengthProperty()).toUInt32();
+        entry.arrayElements.reserve(length);
+        for (quint32 i = 0; i < length; ++i) {
+            const QScriptValue element = scriptValue.property(i);
+            if (element.isObject()) {
+                entry.arrayElements.clear();
+                break;
+            }
+            entry.arrayElements.push_back(element);
+        }
+        entry.isArray = entry.arrayElements.size() == length;
+        if (entry.isArray)
+            entry.scriptValue = scriptValue;
+    }
+    m_propertyCache.insert(PropertyCacheKey(moduleName, propertyName, propertyMap), entry);
+    return entry.isArray ? scriptValueForCachedProperty(entry) : scriptValue;
 }
 
 QVariant ScriptEngine::retrieveFromPropertyCache(const QString &moduleName,
-        const QString &propertyName, const PropertyMapConstPtr &propertyMap)
+        const QString &propertyName, const PropertyMapConstPtr &propertyMap,
+        QScriptValue *scriptValue)
+{
+    const auto it = m_propertyCache.constFind(
+                PropertyCacheKey(moduleName, propertyName, propertyMap));
+    if (it == m_propertyCache.constEnd())
+        return QVariant();
+    if (scriptValue && it->value.isValid())
+        *scriptValue = scriptValueForCachedProperty(it.value());
+    return it->value;
+}
+
+QScriptValue ScriptEngine::scriptValueForCachedProperty(const PropertyCacheEntry &entry)
+{
+    if (!entry.scriptValue.isValid())
+        return toScriptValue(entry.value);
+    if (!entry.isArray)
+        return entry.scriptValue;
+    QScriptValue array = newArray(quint32(entry.arrayElements.size()));
+    for (size_t i = 0; i < entry.arrayElements.size(); ++i)
+        array.setProperty(quint32(i), entry.arrayElements.at(i));
+    return array;
+}
+
+QString ScriptEngine::internedString(const QString &str)
+{
+    if (m_internedStrings.size() >= m_internedStringsPruneThreshold)
+        pruneInternedStrings();
+    return *m_internedStrings.insert(str);
+}
+
+// Drops the strings that only the table itself still refers to, e.g. arguments of commands
+// that have been replaced. Runs in amortized constant time per interned string.
+void ScriptEngine::pruneInternedStrings()
+{
+    for (auto it = m_internedStrings.begin(); it != m_internedStrings.end();) {
+        if (it->isDetached())
+            it = m_internedStrings.erase(it);
+        else
+            ++it;
+    }
+    m_internedStringsPruneThreshold = std::max(1024, 2 * m_internedStrings.size());
+}
+
+QStringList ScriptEngine::internedStrings(const QStringList &list)
+{
+    QStringList result;
+    result.reserve(list.size());
+    for (const QString &str : list)
+        result << internedString(str);
+    return result;
+}
+
+QProcessEnvironment ScriptEngine::internedEnvironment(const QProcessEnvironment &env)
 {
-    return m_propertyCache.value(PropertyCacheKey(moduleName, propertyName, propertyMap));
+    return *m_internedEnvironments.insert(env);
 }
 
 void ScriptEngine::defineProperty(QScriptValue &object, const QString &name,
@@ -376,15 +455,8 @@ void ScriptEngine::importFile(const QString &filePath, QScriptValue &targetObjec
         ScriptImporter::copyProperties(evaluationResult, targetObject);
         return;
     }
-    QFile file(filePath);
-    if (Q_UNLIKELY(!file.open(QFile::ReadOnly)))
-        throw ErrorInfo(tr("Cannot open '%1'.").arg(filePath));
-    QTextStream stream(&file);
-    stream.setCodec("UTF-8");
-    const QString sourceCode = stream.readAll();
-    file.close();
     m_currentDirPathStack.push(FileInfo::path(filePath));
-    evaluationResult = m_scriptImporter->importSourceCode(sourceCode, filePath, targetObject);
+    evaluationResult = m_scriptImporter->importFile(filePath, targetObject);
     m_currentDirPathStack.pop();
 }
 
@@ -645,6 +717,24 @@ ErrorInfo ScriptEngine::lastError(const QScriptValue &v, const CodeLocation &fal
     return ErrorInfo(msg, fallbackLocation);
 }
 
+QScriptValue ScriptEngine::evaluateProgram(const QString &sourceCode, const QString &filePath,
+                                           int line, int column)
+{
+    // The programs are evaluated via copies, because the evaluation can add to the cache.
+    std::vector<QScriptProgram> &programs
+            = m_programCache[std::make_pair(filePath, std::make_pair(line, column))];
+    for (const QScriptProgram &program : programs) {
+        if (program.sourceCode() == sourceCode) {
+            ++m_programCacheHits;
+            return evaluate(QScriptProgram(program));
+        }
+    }
+    ++m_programCacheMisses;
+    const QScriptProgram program(sourceCode, filePath, line);
+    programs.push_back(program);
+    return evaluate(program);
+}
+
 void ScriptEngine::cancel()
 {
     QTimer::singleShot(0, this, [this] { abort(); });
@@ -53,9 +53,11 @@
 #include <QtCore/qhash.h>
 #include <QtCore/qlist.h>
 #include <QtCore/qprocess.h>
+#include <QtCore/qset.h>
 #include <QtCore/qstring.h>
 
 #include <QtScript/qscriptengine.h>
+#include <QtScript/qscriptprogram.h>
 
 #include <memory>
 #include <mutex>
@@ -145,6 +147,8 @@ public:
         m_productsWithRequestedDependencies.clear();
         m_requestedArtifacts.clear();
         m_requestedExports.clear();
+        m_requestedEnvironmentVariables.clear();
+        m_wholeEnvironmentRequested = false;
     }
     PropertySet propertiesRequestedInScript() const { return m_propertiesRequestedInScript; }
     QHash<QString, PropertySet> propertiesRequestedFromArtifact() const {
@@ -164,6 +168,15 @@ public:
     void addImportRequestedInScript(qint64 importValueId);
     std::vector<QString> importedFilesUsedInScript() const;
 
+    // Environment variables looked up via the engine's environment, e.g. by Environment.getEnv().
+    void addRequestedEnvironmentVariable(const QString &name)
+    {
+        m_requestedEnvironmentVariables.insert(name);
+    }
+    Set<QString> requestedEnvironmentVariables() const { return m_requestedEnvironmentVariables; }
+    void setWholeEnvironmentRequested() { m_wholeEnvironmentRequested = true; }
+    bool wholeEnvironmentRequested() const { return m_wholeEnvironmentRequested; }
+
     void setUsesIo() { m_usesIo = true; }
     void clearUsesIo() { m_usesIo = false; }
     bool usesIo() const { return m_usesIo; }
@@ -172,10 +185,17 @@ public:
 
     void setPropertyCacheEnabled(bool enable) { m_propertyCacheEnabled = enable; }
     bool isPropertyCacheEnabled() const { return m_propertyCacheEnabled; }
-    void addToPropertyCache(const QString &moduleName, const QString &propertyName,
-                            const PropertyMapConstPtr &propertyMap, const QVariant &value);
+    QScriptValue addToPropertyCache(const QString &moduleName, const QString &propertyName,
+                                    const PropertyMapConstPtr &propertyMap, const QVariant &value);
     QVariant retrieveFromPropertyCache(const QString &moduleName, const QString &propertyName,
-                                       const PropertyMapConstPtr &propertyMap);
+                                       const PropertyMapConstPtr &propertyMap,
+                                       QScriptValue *scriptValue = nullptr);
+
+    // Lets the commands created by this engine share the data of equal values, so that
+    // they take up less memory.
+    QString internedString(const QString &str);
+    QStringList internedStrings(const QStringList &list);
+    QProcessEnvironment internedEnvironment(const QProcessEnvironment &env);
 
     void defineProperty(QScriptValue &object, const QString &name, const QScriptValue &descriptor);
     void setObservedProperty(QScriptValue &object, const QString &name, const QScriptValue &value);
@@ -218,6 +238,15 @@ public:
     ErrorInfo lastError(const QScriptValue &v,
                         const CodeLocation &fallbackLocation = CodeLocation()) const;
 
+    // Like evaluate(), but parses the same code at the same location only once.
+    QScriptValue evaluateProgram(const QString &sourceCode, const QString &filePath, int line,
+                                 int column);
+    QScriptValue evaluateProgram(const QString &sourceCode, const CodeLocation &location)
+    {
+        return evaluateProgram(sourceCode, location.filePath(), location.line(),
+                               location.column());
+    }
+
     void cancel();
 
     // The active flag is different from QScriptEngine::isEvaluating.
@@ -312,6 +341,18 @@ private:
     friend bool operator==(const PropertyCacheKey &lhs, const PropertyCacheKey &rhs);
     friend uint qHash(const ScriptEngine::PropertyCacheKey &k, uint seed);
 
+    // The converted script value is kept as well, unless scripts could modify it.
+    // Arrays whose elements are immutable are handed out as fresh arrays sharing the elements.
+    struct PropertyCacheEntry
+    {
+        QVariant value;
+        QScriptValue scriptValue;
+        std::vector<QScriptValue> arrayElements;
+        bool isArray = false;
+    };
+    QScriptValue scriptValueForCachedProperty(const PropertyCacheEntry &entry);
+    void pruneInternedStrings();
+
     static std::mutex m_creationDestructionMutex;
     ScriptImporter *m_scriptImporter;
     QScriptClass *m_modulePropertyScriptClass;
@@ -319,9 +360,15 @@ private:
     QScriptClass *m_artifactsScriptClass = nullptr;
     QHash<JsImport, QScriptValue> m_jsImportCache;
     std::unordered_map<QString, QScriptValue> m_jsFileCache;
+    QHash<std::pair<QString, std::pair<int, int>>, std::vector<QScriptProgram>> m_programCache;
+    quint64 m_programCacheHits = 0;
+    quint64 m_programCacheMisses = 0;
     bool m_propertyCacheEnabled;
     bool m_active;
-    QHash<PropertyCacheKey, QVariant> m_propertyCache;
+    QHash<PropertyCacheKey, PropertyCacheEntry> m_propertyCache;
+    QSet<QString> m_internedStrings;
+    int m_internedStringsPruneThreshold = 1024;
+    QSet<QProcessEnvironment> m_internedEnvironments;
     PropertySet m_propertiesRequestedInScript;
     QHash<QString, PropertySet> m_propertiesRequestedFromArtifact;
     Logger &m_logger;
@@ -342,6 +389,8 @@ private:
     QScriptValue m_cancelationError;
     qint64 m_elapsedTimeImporting = -1;
     bool m_usesIo = false;
+    Set<QString> m_requestedEnvironmentVariables;
+    bool m_wholeEnvironmentRequested = false;
     EvalContext m_evalContext;
     std::vector<ResourceAcquiringScriptObject *> m_resourceAcquiringScriptObjects;
     const std::unique_ptr<PrepareScriptObserver> m_observer;
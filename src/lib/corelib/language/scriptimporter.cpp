@@ -42,14 +42,23 @@
 #include "evaluator.h"
 #include "scriptengine.h"
 
+#include <logging/translator.h>
 #include <parser/qmljsastfwd_p.h>
 #include <parser/qmljsastvisitor_p.h>
 #include <parser/qmljslexer_p.h>
 #include <parser/qmljsparser_p.h>
 #include <tools/error.h>
+#include <tools/fileinfo.h>
+#include <tools/filetime.h>
+
+#include <QtCore/qfile.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qtextstream.h>
 
 #include <QtScript/qscriptvalueiterator.h>
 
+#include <mutex>
+
 namespace qbs {
 namespace Internal {
 
@@ -120,35 +129,67 @@ ScriptImporter::ScriptImporter(ScriptEngine *scriptEngine)
 {
 }
 
-QScriptValue ScriptImporter::importSourceCode(const QString &sourceCode, const QString &filePath,
-        QScriptValue &targetObject)
+QScriptValue ScriptImporter::importFile(const QString &filePath, QScriptValue &targetObject)
 {
     Q_ASSERT(targetObject.isObject());
     // The targetObject doesn't get overwritten but enhanced by the contents of the .js file.
     // This is necessary for library imports that consist of multiple js files.
 
-    QString &code = m_sourceCodeCache[filePath];
-    if (code.isEmpty()) {
-        QbsQmlJS::Engine engine;
-        QbsQmlJS::Lexer lexer(&engine);
-        lexer.setCode(sourceCode, 1, false);
-        QbsQmlJS::Parser parser(&engine);
-        if (!parser.parseProgram()) {
-            throw ErrorInfo(parser.errorMessage(), CodeLocation(filePath, parser.errorLineNumber(),
-                                                                parser.errorColumnNumber()));
-        }
-
-        IdentifierExtractor extractor;
-        extractor.start(parser.rootNode());
-        code = QLatin1String("(function(){\n") + sourceCode + extractor.suffix();
-    }
-
+    const QString code = preparedSourceCode(filePath);
     QScriptValue result = m_engine->evaluate(code, filePath, 0);
     throwOnEvaluationError(m_engine, result, [&filePath] () { return CodeLocation(filePath, 0); });
     copyProperties(result, targetObject);
     return result;
 }
 
+struct PreparedSourceCode
+{
+    FileTime lastModified;
+    QString code;
+};
+
+// Reading and parsing a JavaScript file does not depend on the engine it gets evaluated in,
+// so the result is shared by all engines of the process, e.g. those of the JavaScript
+// command executors.
+static std::mutex preparedSourceCodeMutex;
+static QHash<QString, PreparedSourceCode> preparedSourceCodeCache;
+
+QString ScriptImporter::preparedSourceCode(const QString &filePath)
+{
+    const FileTime lastModified = FileInfo(filePath).lastModified();
+    {
+        std::lock_guard<std::mutex> lock(preparedSourceCodeMutex);
+        const auto it = preparedSourceCodeCache.constFind(filePath);
+        if (it != preparedSourceCodeCache.constEnd() && it->lastModified == lastModified)
+            return it->code;
+    }
+
+    QFile file(filePath);
+    if (Q_UNLIKELY(!file.open(QFile::ReadOnly)))
+        throw ErrorInfo(Tr::tr("Cannot open '%1'.").arg(filePath));
+    QTextStream stream(&file);
+    stream.setCodec("UTF-8");
+    const QString sourceCode = stream.readAll();
+    file.close();
+
+    QbsQmlJS::Engine engine;
+    QbsQmlJS::Lexer lexer(&engine);
+    lexer.setCode(sourceCode, 1, false);
+    QbsQmlJS::Parser parser(&engine);
+    if (!parser.parseProgram()) {
+        throw ErrorInfo(parser.errorMessage(), CodeLocation(filePath, parser.errorLineNumber(),
+                                                            parser.errorColumnNumber()));
+    }
+
+    IdentifierExtractor extractor;
+    extractor.start(parser.rootNode());
+    const QString code = QLatin1String("(function(){\n") + sourceCode + extractor.suffix();
+
+    std::lock_guard<std::mutex> lock(preparedSourceCodeMutex);
+    preparedSourceCodeCache.insert(filePath, PreparedSourceCode{lastModified, code});
+    return code;
+}
+
 void ScriptImporter::copyProperties(const QScriptValue &src, QScriptValue &dst)
 {
     QScriptValueIterator it(src);
@@ -40,7 +40,7 @@
 #ifndef SCRIPTIMPORTER_H
 #define SCRIPTIMPORTER_H
 
-#include <QtCore/qhash.h>
+#include <QtCore/qstring.h>
 
 #include <QtScript/qscriptvalue.h>
 
@@ -53,13 +53,14 @@ class ScriptImporter
 {
 public:
     ScriptImporter(ScriptEngine *scriptEngine);
-    QScriptValue importSourceCode(const QString &sourceCode, const QString &filePath, QScriptValue &targetObject);
+    QScriptValue importFile(const QString &filePath, QScriptValue &targetObject);
 
     static void copyProperties(const QScriptValue &src, QScriptValue &dst);
 
 private:
+    static QString preparedSourceCode(const QString &filePath);
+
     ScriptEngine *m_engine;
-    QHash<QString, QString> m_sourceCodeCache;
 };
 
 } // namespace Internal
@@ -45,9 +45,24 @@
 #include <tools/qbsassert.h>
 #include <tools/qttools.h>
 
+#include <utility>
+
 namespace qbs {
 namespace Internal {
 
+// Lets std::make_shared access the non-public constructors, so that a value and the
+// reference count of its shared pointer are allocated in a single block.
+template<typename T> class SharedValue : public T
+{
+public:
+    template<typename... Args> SharedValue(Args &&...args) : T(std::forward<Args>(args)...) { }
+};
+
+template<typename T, typename... Args> static std::shared_ptr<T> makeValue(Args &&...args)
+{
+    return std::make_shared<SharedValue<T>>(std::forward<Args>(args)...);
+}
+
 Value::Value(Type t, bool createdByPropertiesBlock)
     : m_type(t), m_definingItem(nullptr), m_createdByPropertiesBlock(createdByPropertiesBlock)
 {
@@ -112,7 +127,7 @@ JSSourceValue::JSSourceValue(const JSSourceValue &other) : Value(other)
 
 JSSourceValuePtr JSSourceValue::create(bool createdByPropertiesBlock)
 {
-    return JSSourceValuePtr(new JSSourceValue(createdByPropertiesBlock));
+    return makeValue<JSSourceValue>(createdByPropertiesBlock);
 }
 
 JSSourceValue::~JSSourceValue()
@@ -121,7 +136,7 @@ JSSourceValue::~JSSourceValue()
 
 ValuePtr JSSourceValue::clone() const
 {
-    return JSSourceValuePtr(new JSSourceValue(*this));
+    return makeValue<JSSourceValue>(*this);
 }
 
 QString JSSourceValue::sourceCodeForEvaluation() const
@@ -175,7 +190,7 @@ ItemValue::ItemValue(Item *item, bool createdByPropertiesBlock)
 
 ItemValuePtr ItemValue::create(Item *item, bool createdByPropertiesBlock)
 {
-    return ItemValuePtr(new ItemValue(item, createdByPropertiesBlock));
+    return makeValue<ItemValue>(item, createdByPropertiesBlock);
 }
 
 ValuePtr ItemValue::clone() const
@@ -195,29 +210,29 @@ VariantValuePtr VariantValue::create(const QVariant &v)
         return invalidValue();
     if (static_cast<QMetaType::Type>(v.type()) == QMetaType::Bool)
         return v.toBool() ? VariantValue::trueValue() : VariantValue::falseValue();
-    return VariantValuePtr(new VariantValue(v));
+    return makeValue<VariantValue>(v);
 }
 
 ValuePtr VariantValue::clone() const
 {
-    return VariantValuePtr(new VariantValue(*this));
+    return makeValue<VariantValue>(*this);
 }
 
 const VariantValuePtr &VariantValue::falseValue()
 {
-    static const VariantValuePtr v = VariantValuePtr(new VariantValue(false));
+    static const VariantValuePtr v = makeValue<VariantValue>(false);
     return v;
 }
 
 const VariantValuePtr &VariantValue::trueValue()
 {
-    static const VariantValuePtr v = VariantValuePtr(new VariantValue(true));
+    static const VariantValuePtr v = makeValue<VariantValue>(true);
     return v;
 }
 
 const VariantValuePtr &VariantValue::invalidValue()
 {
-    static const VariantValuePtr v = VariantValuePtr(new VariantValue(QVariant()));
+    static const VariantValuePtr v = makeValue<VariantValue>(QVariant());
     return v;
 }
 
@@ -98,6 +98,7 @@ public:
 class JSSourceValue : public Value
 {
     friend class ItemReaderASTVisitor;
+protected:
     JSSourceValue(bool createdByPropertiesBlock);
     JSSourceValue(const JSSourceValue &other);
 
@@ -190,6 +191,7 @@ private:
 
 class ItemValue : public Value
 {
+protected:
     ItemValue(Item *item, bool createdByPropertiesBlock);
 public:
     static ItemValuePtr create(Item *item, bool createdByPropertiesBlock = false);
@@ -207,6 +209,7 @@ private:
 
 class VariantValue : public Value
 {
+protected:
     VariantValue(const QVariant &v);
 public:
     static VariantValuePtr create(const QVariant &v = QVariant());
@@ -43,6 +43,7 @@
 #include "hostosinfo.h"
 #include "processutils.h"
 #include "progressobserver.h"
+#include "qbsassert.h"
 #include "stringconstants.h"
 
 #include <logging/translator.h>
@@ -159,8 +160,32 @@ BuildGraphLocker::BuildGraphLocker(const QString &buildGraphFilePath, const Logg
 
 BuildGraphLocker::~BuildGraphLocker()
 {
+    ErrorInfo writeError = waitForPendingWrite();
+    if (writeError.hasError()) {
+        // The job that stored the build graph has already finished, so this is the only
+        // place where the failure can be reported.
+        writeError.prepend(Tr::tr("The build graph could not be stored. The next build "
+                                  "will start from the previously stored state."));
+        if (m_logger.logSink())
+            m_logger.printWarning(writeError);
+        else
+            qWarning("%s", qPrintable(writeError.toString()));
+    }
     m_lockFile.unlock();
 }
 
+void BuildGraphLocker::setPendingWrite(std::future<ErrorInfo> &&pendingWrite)
+{
+    QBS_CHECK(!m_pendingWrite.valid());
+    m_pendingWrite = std::move(pendingWrite);
+}
+
+ErrorInfo BuildGraphLocker::waitForPendingWrite()
+{
+    if (!m_pendingWrite.valid())
+        return ErrorInfo();
+    return m_pendingWrite.get();
+}
+
 } // namespace Internal
 } // namespace qbs
@@ -40,11 +40,14 @@
 #ifndef QBS_BUILDGRAPHLOCKER_H
 #define QBS_BUILDGRAPHLOCKER_H
 
+#include "error.h"
+
 #include <logging/logger.h>
 
 #include <QtCore/qlockfile.h>
 #include <QtCore/qstring.h>
 
+#include <future>
 #include <queue>
 
 namespace qbs {
@@ -75,8 +78,13 @@ public:
                               bool waitIndefinitely, ProgressObserver *observer);
     ~BuildGraphLocker();
 
+    // The lock is held until a pending write has finished.
+    void setPendingWrite(std::future<ErrorInfo> &&pendingWrite);
+    ErrorInfo waitForPendingWrite();
+
 private:
     QLockFile m_lockFile;
+    std::future<ErrorInfo> m_pendingWrite;
     Logger m_logger;
     DirectoryManager m_dirManager;
 };
@@ -116,6 +116,22 @@ void ProcessErrorPacket::doDeserialize(QDataStream &stream)
 }
 
 
+ProcessOutputPacket::ProcessOutputPacket(quintptr token)
+    : LauncherPacket(LauncherPacketType::ProcessOutput, token)
+{
+}
+
+void ProcessOutputPacket::doSerialize(QDataStream &stream) const
+{
+    stream << stdOut << stdErr;
+}
+
+void ProcessOutputPacket::doDeserialize(QDataStream &stream)
+{
+    stream >> stdOut >> stdErr;
+}
+
+
 ProcessFinishedPacket::ProcessFinishedPacket(quintptr token)
     : LauncherPacket(LauncherPacketType::ProcessFinished, token)
 {
@@ -52,7 +52,7 @@ namespace qbs {
 namespace Internal {
 
 enum class LauncherPacketType {
-    Shutdown, StartProcess, StopProcess, ProcessError, ProcessFinished
+    Shutdown, StartProcess, StopProcess, ProcessError, ProcessFinished, ProcessOutput
 };
 
 class PacketParser
@@ -153,6 +153,21 @@ private:
     void doDeserialize(QDataStream &stream) override;
 };
 
+// Forwards output while the process is still running, so that it does not pile up
+// in the launcher until the process has finished.
+class ProcessOutputPacket : public LauncherPacket
+{
+public:
+    ProcessOutputPacket(quintptr token);
+
+    QByteArray stdOut;
+    QByteArray stdErr;
+
+private:
+    void doSerialize(QDataStream &stream) const override;
+    void doDeserialize(QDataStream &stream) override;
+};
+
 class ProcessFinishedPacket : public LauncherPacket
 {
 public:
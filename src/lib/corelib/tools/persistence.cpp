@@ -43,12 +43,99 @@
 #include <logging/translator.h>
 #include <tools/error.h>
 
+#include <QtCore/qbuffer.h>
 #include <QtCore/qdir.h>
+#include <QtCore/qsavefile.h>
+
+#include <algorithm>
+#include <thread>
 
 namespace qbs {
 namespace Internal {
 
-static const char QBS_PERSISTENCE_MAGIC[] = "QBSPERSISTENCE-124";
+static const char QBS_PERSISTENCE_MAGIC[] = "QBSPERSISTENCE-128";
+
+// Stored right after the magic token.
+enum PersistenceFlag : quint8 {
+    NoPersistenceFlags = 0,
+    CompressedPayload = 1 // Everything after the head data is a list of zlib-compressed chunks.
+};
+
+// Chunks are compressed and uncompressed independently of each other, so we can do it
+// in parallel.
+static const int CompressionChunkSize = 4 * 1024 * 1024;
+static const int CompressionLevel = 1; // Build graphs are highly redundant; speed matters more.
+
+static bool compressionEnabled()
+{
+    return qEnvironmentVariableIsEmpty("QBS_UNCOMPRESSED_BUILD_GRAPH");
+}
+
+template<typename F> static void forEachIndexConcurrently(int count, const F &f)
+{
+    const int threadCount = std::min(count,
+                                     std::max(1, int(std::thread::hardware_concurrency())));
+    std::vector<std::future<void>> workers;
+    for (int t = 1; t < threadCount; ++t) {
+        workers.push_back(std::async(std::launch::async, [&f, t, threadCount, count] {
+            for (int i = t; i < count; i += threadCount)
+                f(i);
+        }));
+    }
+    for (int i = 0; i < count; i += threadCount)
+        f(i);
+    for (std::future<void> &w : workers)
+        w.get();
+}
+
+static QByteArray compressedPayload(const QByteArray &payload)
+{
+    const int chunkCount = (payload.size() + CompressionChunkSize - 1) / CompressionChunkSize;
+    std::vector<QByteArray> chunks(chunkCount);
+    forEachIndexConcurrently(chunkCount, [&payload, &chunks](int i) {
+        const int offset = i * CompressionChunkSize;
+        chunks[i] = qCompress(reinterpret_cast<const uchar *>(payload.constData()) + offset,
+                              std::min(CompressionChunkSize, payload.size() - offset),
+                              CompressionLevel);
+    });
+    QByteArray compressedData;
+    QDataStream stream(&compressedData, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_4_8);
+    stream << quint32(chunkCount);
+    for (const QByteArray &chunk : chunks)
+        stream << chunk;
+    return compressedData;
+}
+
+static QByteArray uncompressedPayload(QDataStream &stream, const QString &filePath)
+{
+    quint32 chunkCount;
+    stream >> chunkCount;
+    std::vector<QByteArray> chunks;
+    for (quint32 i = 0; i < chunkCount && stream.status() == QDataStream::Ok; ++i) {
+        QByteArray chunk;
+        stream >> chunk;
+        chunks.push_back(chunk);
+    }
+    const ErrorInfo corruptionError(Tr::tr("Cannot use stored build graph at '%1': "
+                                           "File is corrupted.").arg(filePath));
+    if (stream.status() != QDataStream::Ok)
+        throw corruptionError;
+    forEachIndexConcurrently(int(chunks.size()), [&chunks](int i) {
+        chunks[i] = qUncompress(chunks[i]);
+    });
+    int totalSize = 0;
+    for (const QByteArray &chunk : chunks) {
+        if (chunk.isEmpty())
+            throw corruptionError;
+        totalSize += chunk.size();
+    }
+    QByteArray payload;
+    payload.reserve(totalSize);
+    for (const QByteArray &chunk : chunks)
+        payload.append(chunk);
+    return payload;
+}
 
 NoBuildGraphError::NoBuildGraphError(const QString &filePath)
     : ErrorInfo(Tr::tr("Build graph not found for configuration '%1'. Expected location was '%2'.")
@@ -56,7 +143,8 @@ NoBuildGraphError::NoBuildGraphError(const QString &filePath)
 {
 }
 
-PersistentPool::PersistentPool(Logger &logger) : m_logger(logger)
+PersistentPool::PersistentPool(Logger &logger)
+    : m_compressionEnabled(compressionEnabled()), m_logger(logger)
 {
     Q_UNUSED(m_logger);
     m_stream.setVersion(QDataStream::Qt_4_8);
@@ -88,13 +176,26 @@ void PersistentPool::load(const QString &filePath)
                          QString::fromLatin1(magic)));
     }
 
-    m_stream >> m_headData.projectConfig;
-    file.release();
+    quint8 flags;
+    m_stream >> flags >> m_headData.projectConfig;
+    if (flags & CompressedPayload) {
+        m_stream.setDevice(nullptr);
+        QDataStream fileStream(file.get());
+        fileStream.setVersion(m_stream.version());
+        const QByteArray payload = uncompressedPayload(fileStream, filePath);
+        std::unique_ptr<QBuffer> buffer(new QBuffer);
+        buffer->setData(payload);
+        buffer->open(QIODevice::ReadOnly);
+        m_stream.setDevice(buffer.release());
+    } else {
+        file.release();
+    }
     m_loadedRaw.clear();
     m_loaded.clear();
     m_storageIndices.clear();
     m_stringStorage.clear();
     m_inverseStringStorage.clear();
+    m_variantMapStorage.clear();
 }
 
 void PersistentPool::setupWriteStream(const QString &filePath)
@@ -105,26 +206,26 @@ void PersistentPool::setupWriteStream(const QString &filePath)
                         .arg(dirPath));
     }
 
-    if (QFile::exists(filePath) && !QFile::remove(filePath)) {
-        throw ErrorInfo(Tr::tr("Failure storing build graph: Cannot remove old file '%1'")
-                        .arg(filePath));
-    }
-    QBS_CHECK(!QFile::exists(filePath));
-    std::unique_ptr<QFile> file(new QFile(filePath));
-    if (!file->open(QFile::WriteOnly)) {
-        throw ErrorInfo(Tr::tr("Failure storing build graph: "
-                "Cannot open file '%1' for writing: %2").arg(filePath, file->errorString()));
-    }
-
-    m_stream.setDevice(file.release());
-    m_stream << QByteArray(qstrlen(QBS_PERSISTENCE_MAGIC), 0) << m_headData.projectConfig;
+    // The build graph is serialized into memory first. This way, the data structures
+    // are only accessed while the caller is still in control of them, and the potentially
+    // slow file operations can be deferred (see finalizeWriteStreamInBackground()).
+    std::unique_ptr<QBuffer> buffer(new QBuffer);
+    buffer->open(QIODevice::WriteOnly);
+    m_writeFilePath = filePath;
+    m_stream.setDevice(buffer.release());
+    m_stream << QByteArray(qstrlen(QBS_PERSISTENCE_MAGIC), 0)
+             << quint8(m_compressionEnabled ? CompressedPayload : NoPersistenceFlags)
+             << m_headData.projectConfig;
+    m_payloadOffset = int(m_stream.device()->pos());
     m_lastStoredObjectId = 0;
     m_lastStoredStringId = 0;
     m_lastStoredEnvId = 0;
     m_lastStoredStringListId = 0;
+    m_variantMapStorage.clear();
+    m_variantMapIds.clear();
 }
 
-void PersistentPool::finalizeWriteStream()
+QByteArray PersistentPool::takeSerializedData()
 {
     if (m_stream.status() != QDataStream::Ok)
         throw ErrorInfo(Tr::tr("Failure serializing build graph."));
@@ -132,12 +233,51 @@ void PersistentPool::finalizeWriteStream()
     m_stream << QByteArray(QBS_PERSISTENCE_MAGIC);
     if (m_stream.status() != QDataStream::Ok)
         throw ErrorInfo(Tr::tr("Failure serializing build graph."));
-    const auto file = static_cast<QFile *>(m_stream.device());
-    if (!file->flush()) {
-        file->close();
-        file->remove();
-        throw ErrorInfo(Tr::tr("Failure serializing build graph: %1").arg(file->errorString()));
+    const QByteArray data = static_cast<QBuffer *>(m_stream.device())->buffer();
+    closeStream();
+    return data;
+}
+
+static QByteArray fileContents(const QByteArray &data, int payloadOffset, bool compress)
+{
+    if (!compress)
+        return data;
+    return data.left(payloadOffset) + compressedPayload(data.mid(payloadOffset));
+}
+
+// Goes through a temporary file that replaces the old build graph only after all data
+// has been written, so a crash or a full disk cannot leave a truncated build graph behind.
+static void writeBuildGraphFile(const QString &filePath, const QByteArray &data)
+{
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        throw ErrorInfo(Tr::tr("Failure storing build graph: "
+                "Cannot open file '%1' for writing: %2").arg(filePath, file.errorString()));
     }
+    if (file.write(data) != data.size() || !file.commit())
+        throw ErrorInfo(Tr::tr("Failure serializing build graph: %1").arg(file.errorString()));
+}
+
+void PersistentPool::finalizeWriteStream()
+{
+    writeBuildGraphFile(m_writeFilePath,
+                        fileContents(takeSerializedData(), m_payloadOffset, m_compressionEnabled));
+}
+
+std::future<ErrorInfo> PersistentPool::finalizeWriteStreamInBackground()
+{
+    const QString filePath = m_writeFilePath;
+    const QByteArray data = takeSerializedData();
+    const int payloadOffset = m_payloadOffset;
+    const bool compress = m_compressionEnabled;
+    return std::async(std::launch::async, [filePath, data, payloadOffset, compress]() -> ErrorInfo {
+        try {
+            writeBuildGraphFile(filePath, fileContents(data, payloadOffset, compress));
+        } catch (const ErrorInfo &error) {
+            return error;
+        }
+        return ErrorInfo();
+    });
 }
 
 void PersistentPool::closeStream()
@@ -163,7 +303,7 @@ void PersistentPool::storeVariant(const QVariant &variant)
         store(variant.toList());
         break;
     case QMetaType::QVariantMap:
-        store(variant.toMap());
+        storeVariantMap(variant.toMap());
         break;
     default:
         m_stream << variant;
@@ -185,7 +325,7 @@ QVariant PersistentPool::loadVariant()
         value = load<QVariantList>();
         break;
     case QMetaType::QVariantMap:
-        value = load<QVariantMap>();
+        value = loadVariantMap();
         break;
     default:
         m_stream >> value;
@@ -193,12 +333,52 @@ QVariant PersistentPool::loadVariant()
     return value;
 }
 
+// Module property maps with equal values are shared between products
+// (see PropertyMapInterner), so we store every shared instance only once.
+// The address of a map's first value identifies its shared data. Keeping a reference
+// to the map makes sure that this address is not re-used while the pool is storing.
+void PersistentPool::storeVariantMap(const QVariantMap &map)
+{
+    if (map.isEmpty()) {
+        m_stream << EmptyValueId;
+        return;
+    }
+    const void * const dataAddress = &map.constBegin().value();
+    PersistentObjectId id = m_variantMapIds.value(dataAddress, ValueNotFoundId);
+    if (id != ValueNotFoundId) {
+        m_stream << id;
+        return;
+    }
+    id = PersistentObjectId(m_variantMapStorage.size());
+    m_variantMapIds.insert(dataAddress, id);
+    m_variantMapStorage.push_back(map);
+    m_stream << id;
+    store(map);
+}
+
+QVariantMap PersistentPool::loadVariantMap()
+{
+    const PersistentObjectId id = load<PersistentObjectId>();
+    if (id == EmptyValueId)
+        return QVariantMap();
+    if (id < PersistentObjectId(m_variantMapStorage.size()))
+        return m_variantMapStorage.at(id);
+
+    // Nested maps get higher ids than the map containing them.
+    m_variantMapStorage.resize(id + 1);
+    const QVariantMap map = load<QVariantMap>();
+    m_variantMapStorage[id] = map;
+    return map;
+}
+
 void PersistentPool::clear()
 {
     m_loaded.clear();
     m_storageIndices.clear();
     m_stringStorage.clear();
     m_inverseStringStorage.clear();
+    m_variantMapStorage.clear();
+    m_variantMapIds.clear();
 }
 
 void PersistentPool::doLoadValue(QString &s)
@@ -42,6 +42,7 @@
 
 #include "error.h"
 #include <logging/logger.h>
+#include <tools/qbs_export.h>
 #include <tools/qbsassert.h>
 #include <tools/qttools.h>
 
@@ -52,6 +53,7 @@
 #include <QtCore/qstring.h>
 #include <QtCore/qvariant.h>
 
+#include <future>
 #include <memory>
 #include <type_traits>
 #include <unordered_map>
@@ -69,7 +71,7 @@ public:
 template<typename T, typename Enable = void>
 struct PPHelper;
 
-class PersistentPool
+class QBS_AUTOTEST_EXPORT PersistentPool
 {
 public:
     PersistentPool(Logger &logger);
@@ -128,6 +130,7 @@ public:
     void load(const QString &filePath);
     void setupWriteStream(const QString &filePath);
     void finalizeWriteStream();
+    std::future<ErrorInfo> finalizeWriteStreamInBackground();
     void closeStream();
     void clear();
 
@@ -149,6 +152,10 @@ private:
 
     void storeVariant(const QVariant &variant);
     QVariant loadVariant();
+    void storeVariantMap(const QVariantMap &map);
+    QVariantMap loadVariantMap();
+
+    QByteArray takeSerializedData();
 
     template <typename T> void idStoreValue(const T &value);
 
@@ -168,6 +175,9 @@ private:
     static const PersistentObjectId EmptyValueId = -2;
 
     QDataStream m_stream;
+    QString m_writeFilePath;
+    int m_payloadOffset = 0;
+    const bool m_compressionEnabled;
     HeadData m_headData;
     std::vector<void *> m_loadedRaw;
     std::vector<std::shared_ptr<void>> m_loaded;
@@ -183,6 +193,8 @@ private:
     std::vector<QStringList> m_stringListStorage;
     QHash<QStringList, int> m_inverseStringListStorage;
     PersistentObjectId m_lastStoredStringListId;
+    std::vector<QVariantMap> m_variantMapStorage;
+    QHash<const void *, PersistentObjectId> m_variantMapIds;
     Logger &m_logger;
 
     template<typename T, typename Enable>
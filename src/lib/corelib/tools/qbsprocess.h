@@ -81,6 +81,7 @@ private:
     void handlePacket(qbs::Internal::LauncherPacketType type, quintptr token,
                       const QByteArray &payload);
     void handleErrorPacket(const QByteArray &packetData);
+    void handleOutputPacket(const QByteArray &packetData);
     void handleFinishedPacket(const QByteArray &packetData);
     void handleSocketReady();
 
@@ -177,23 +177,29 @@ template<typename T> Set<T>::Set(const std::initializer_list<T> &list) : m_data(
     m_data.erase(last, m_data.end());
 }
 
+// The bulk operations below never erase or insert single elements in the middle of the vector,
+// as that would make them quadratic for large sets, e.g. the children of a linker node.
 template<typename T> Set<T> &Set<T>::intersect(const Set<T> &other)
 {
-    iterator it = begin();
-    const_iterator otherIt = other.cbegin();
-    while (it != end()) {
-        if (otherIt == other.cend()) {
-            m_data.erase(it, end());
-            break;
-        }
+    auto write = m_data.begin();
+    auto it = m_data.begin();
+    auto otherIt = other.cbegin();
+    while (it != m_data.end() && otherIt != other.cend()) {
         if (*it < *otherIt) {
-            it = erase(it);
+            ++it;
             continue;
         }
-        if (!(*otherIt < *it))
-            ++it;
+        if (*otherIt < *it) {
+            ++otherIt;
+            continue;
+        }
+        if (write != it)
+            *write = std::move(*it);
+        ++write;
+        ++it;
         ++otherIt;
     }
+    m_data.erase(write, m_data.end());
     return *this;
 }
 
@@ -242,16 +248,39 @@ template<typename T> Set<T> &Set<T>::unite(const Set<T> &other)
         m_data = other.m_data;
         return *this;
     }
-    auto lowerBound = m_data.begin();
+
+    // First pass: Find out how many elements are new.
+    size_type newElementCount = 0;
+    auto lowerBound = m_data.cbegin();
     for (auto otherIt = other.cbegin(); otherIt != other.cend(); ++otherIt) {
-        lowerBound = std::lower_bound(lowerBound, m_data.end(), *otherIt);
-        if (lowerBound == m_data.end()) {
-            m_data.reserve(size() + std::distance(otherIt, other.cend()));
-            std::copy(otherIt, other.cend(), std::back_inserter(m_data));
-            return *this;
+        lowerBound = std::lower_bound(lowerBound, m_data.cend(), *otherIt);
+        if (lowerBound == m_data.cend()) {
+            newElementCount += std::distance(otherIt, other.cend());
+            break;
         }
         if (*otherIt < *lowerBound)
-            lowerBound = m_data.insert(lowerBound, *otherIt);
+            ++newElementCount;
+    }
+    if (newElementCount == 0)
+        return *this;
+
+    // Second pass: Merge from the back, so every element is moved at most once.
+    const size_type oldSize = size();
+    m_data.resize(oldSize + newElementCount);
+    auto read = m_data.begin() + oldSize;
+    auto write = m_data.end();
+    auto otherIt = other.cend();
+    while (write != read) {
+        const T &otherValue = *(otherIt - 1);
+        if (read != m_data.begin() && otherValue < *(read - 1)) {
+            *--write = std::move(*--read);
+            continue;
+        }
+        if (read == m_data.begin() || *(read - 1) < otherValue)
+            *--write = otherValue;
+        else
+            *--write = std::move(*--read);
+        --otherIt;
     }
     return *this;
 }
@@ -363,14 +392,21 @@ template<typename T> Set<T> &Set<T>::subtract(const Set<T> &other)
 {
     if (empty() || other.empty())
         return *this;
-    auto lowerBound = m_data.begin();
-    for (auto otherIt = other.cbegin(); otherIt != other.cend(); ++otherIt) {
-        lowerBound = std::lower_bound(lowerBound, m_data.end(), *otherIt);
-        if (lowerBound == m_data.end())
-            return *this;
-        if (!(*otherIt < *lowerBound))
-            lowerBound = m_data.erase(lowerBound);
+    auto read = std::lower_bound(m_data.begin(), m_data.end(), *other.cbegin());
+    auto write = read;
+    const auto keep = [&write](iterator first, iterator last) {
+        write = write == first ? last : std::move(first, last, write);
+    };
+    for (auto otherIt = other.cbegin(); otherIt != other.cend() && read != m_data.end();
+         ++otherIt) {
+        const auto lowerBound = std::lower_bound(read, m_data.end(), *otherIt);
+        keep(read, lowerBound);
+        read = lowerBound;
+        if (read != m_data.end() && !(*otherIt < *read))
+            ++read;
     }
+    keep(read, m_data.end());
+    m_data.erase(write, m_data.end());
     return *this;
 }
 
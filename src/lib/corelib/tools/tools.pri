@@ -49,6 +49,7 @@ HEADERS += \
     $$PWD/stlutils.h \
     $$PWD/stringutils.h \
     $$PWD/toolchains.h \
+    $$PWD/vectormap.h \
     $$PWD/hostosinfo.h \
     $$PWD/buildoptions.h \
     $$PWD/installoptions.h \
@@ -0,0 +1,192 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_VECTORMAP_H
+#define QBS_VECTORMAP_H
+
+#include <QtCore/qlist.h>
+#include <QtCore/qvector.h>
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace qbs {
+namespace Internal {
+
+// A map that keeps its entries in a sorted, implicitly shared vector. It has the parts of the
+// QMap interface that we need, but needs only a single allocation and looks up keys via
+// binary search over contiguous memory. Intended for small maps that are read much more often
+// than they are modified, such as the properties of an item.
+template<typename Key, typename T> class VectorMap
+{
+    using Entry = std::pair<Key, T>;
+    using Data = QVector<Entry>;
+
+public:
+    template<typename DataIterator, typename Value> class IteratorBase
+    {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Value *;
+        using reference = Value &;
+
+        IteratorBase() = default;
+        explicit IteratorBase(DataIterator it) : m_it(it) { }
+        template<typename OtherIterator, typename OtherValue>
+        IteratorBase(const IteratorBase<OtherIterator, OtherValue> &other) : m_it(other.m_it) { }
+
+        const Key &key() const { return m_it->first; }
+        Value &value() const { return m_it->second; }
+        Value &operator*() const { return m_it->second; }
+        Value *operator->() const { return &m_it->second; }
+
+        IteratorBase &operator++() { ++m_it; return *this; }
+        IteratorBase operator++(int) { IteratorBase old = *this; ++m_it; return old; }
+        IteratorBase &operator--() { --m_it; return *this; }
+        IteratorBase operator--(int) { IteratorBase old = *this; --m_it; return old; }
+
+        bool operator==(const IteratorBase &other) const { return m_it == other.m_it; }
+        bool operator!=(const IteratorBase &other) const { return m_it != other.m_it; }
+
+    private:
+        template<typename, typename> friend class IteratorBase;
+        friend class VectorMap;
+        DataIterator m_it = DataIterator();
+    };
+
+    using key_type = Key;
+    using mapped_type = T;
+    using size_type = int;
+    using iterator = IteratorBase<typename Data::iterator, T>;
+    using const_iterator = IteratorBase<typename Data::const_iterator, const T>;
+    using ConstIterator = const_iterator;
+
+    iterator begin() { return iterator(m_data.begin()); }
+    iterator end() { return iterator(m_data.end()); }
+    const_iterator begin() const { return const_iterator(m_data.cbegin()); }
+    const_iterator end() const { return const_iterator(m_data.cend()); }
+    const_iterator cbegin() const { return const_iterator(m_data.cbegin()); }
+    const_iterator cend() const { return const_iterator(m_data.cend()); }
+    const_iterator constBegin() const { return const_iterator(m_data.cbegin()); }
+    const_iterator constEnd() const { return const_iterator(m_data.cend()); }
+
+    bool empty() const { return m_data.isEmpty(); }
+    bool isEmpty() const { return m_data.isEmpty(); }
+    size_type size() const { return m_data.size(); }
+    size_type count() const { return m_data.size(); }
+    void clear() { m_data.clear(); }
+    void reserve(size_type size) { m_data.reserve(size); }
+
+    const_iterator find(const Key &key) const { return constFind(key); }
+    const_iterator constFind(const Key &key) const
+    {
+        const auto it = lowerBound(m_data.cbegin(), m_data.cend(), key);
+        return const_iterator(it != m_data.cend() && it->first == key ? it : m_data.cend());
+    }
+    iterator find(const Key &key)
+    {
+        const auto it = lowerBound(m_data.begin(), m_data.end(), key);
+        return iterator(it != m_data.end() && it->first == key ? it : m_data.end());
+    }
+
+    bool contains(const Key &key) const { return constFind(key) != constEnd(); }
+
+    T value(const Key &key, const T &defaultValue = T()) const
+    {
+        const const_iterator it = constFind(key);
+        return it != constEnd() ? it.value() : defaultValue;
+    }
+
+    T &operator[](const Key &key)
+    {
+        auto it = lowerBound(m_data.begin(), m_data.end(), key);
+        if (it == m_data.end() || it->first != key)
+            it = m_data.insert(it, Entry(key, T()));
+        return it->second;
+    }
+
+    iterator insert(const Key &key, const T &value)
+    {
+        auto it = lowerBound(m_data.begin(), m_data.end(), key);
+        if (it != m_data.end() && it->first == key)
+            it->second = value;
+        else
+            it = m_data.insert(it, Entry(key, value));
+        return iterator(it);
+    }
+
+    int remove(const Key &key)
+    {
+        const auto it = lowerBound(m_data.cbegin(), m_data.cend(), key);
+        if (it == m_data.cend() || it->first != key)
+            return 0;
+        m_data.remove(int(it - m_data.cbegin()));
+        return 1;
+    }
+
+    QList<Key> keys() const
+    {
+        QList<Key> result;
+        result.reserve(m_data.size());
+        for (const Entry &e : m_data)
+            result << e.first;
+        return result;
+    }
+
+    bool operator==(const VectorMap &other) const { return m_data == other.m_data; }
+    bool operator!=(const VectorMap &other) const { return m_data != other.m_data; }
+
+private:
+    template<typename It> static It lowerBound(It begin, It end, const Key &key)
+    {
+        return std::lower_bound(begin, end, key, [](const Entry &e, const Key &k) {
+            return e.first < k;
+        });
+    }
+
+    Data m_data;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_VECTORMAP_H
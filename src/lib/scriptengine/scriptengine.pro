@@ -40,7 +40,8 @@ win32 {
 # Suppress 'LEAK' messages (see QTBUG-18201)
 DEFINES += LOG_DISABLED=1
 
-JAVASCRIPTCORE_JIT = no
+qbs_enable_bundled_qtscript_jit: JAVASCRIPTCORE_JIT = yes
+else: JAVASCRIPTCORE_JIT = no
 include(../../shared/qtscript/src/3rdparty/javascriptcore/JavaScriptCore/JavaScriptCore.pri)
 
 # This line copied from WebCore.pro
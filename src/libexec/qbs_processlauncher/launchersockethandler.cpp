@@ -188,6 +188,16 @@ void LauncherSocketHandler::handleProcessError()
     sendPacket(packet);
 }
 
+void LauncherSocketHandler::handleProcessOutput()
+{
+    Process * const proc = senderProcess();
+    ProcessOutputPacket packet(proc->token());
+    packet.stdOut = proc->readAllStandardOutput();
+    packet.stdErr = proc->readAllStandardError();
+    if (!packet.stdOut.isEmpty() || !packet.stdErr.isEmpty())
+        sendPacket(packet);
+}
+
 void LauncherSocketHandler::handleProcessFinished()
 {
     Process * proc = senderProcess();
@@ -275,6 +285,10 @@ Process *LauncherSocketHandler::setupProcess(quintptr token)
     const auto p = new Process(token, this);
     connect(p, static_cast<void (QProcess::*)(QProcess::ProcessError)>(&QProcess::error),
             this, &LauncherSocketHandler::handleProcessError);
+    connect(p, &QProcess::readyReadStandardOutput,
+            this, &LauncherSocketHandler::handleProcessOutput);
+    connect(p, &QProcess::readyReadStandardError,
+            this, &LauncherSocketHandler::handleProcessOutput);
     connect(p, static_cast<void (QProcess::*)(int)>(&QProcess::finished),
             this, &LauncherSocketHandler::handleProcessFinished);
     connect(p, &Process::failedToStop, this, &LauncherSocketHandler::handleStopFailure);
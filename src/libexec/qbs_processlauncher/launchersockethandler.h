@@ -68,6 +68,7 @@ private:
     void handleSocketError();
     void handleSocketClosed();
     void handleProcessError();
+    void handleProcessOutput();
     void handleProcessFinished();
     void handleStopFailure();
 
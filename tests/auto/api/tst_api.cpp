@@ -238,6 +238,43 @@ void TestApi::baseProperties()
     VERIFY_NO_ERROR(errorInfo);
 }
 
+void TestApi::buildGraphAfterReResolve()
+{
+    // The build graph is written in the background after building. Re-resolving right away
+    // must not let that write overwrite the build graph of the re-resolved project.
+    qbs::SetupProjectParameters setupParams
+            = defaultSetupParameters("build-graph-after-re-resolve");
+    std::unique_ptr<qbs::SetupProjectJob> setupJob(qbs::Project().setupProject(setupParams,
+                                                                              m_logSink, 0));
+    waitForFinished(setupJob.get());
+    QVERIFY2(!setupJob->error().hasError(), qPrintable(setupJob->error().toString()));
+    qbs::Project project = setupJob->project();
+    std::unique_ptr<qbs::BuildJob> buildJob(project.buildAllProducts(qbs::BuildOptions()));
+    waitForFinished(buildJob.get());
+    QVERIFY2(!buildJob->error().hasError(), qPrintable(buildJob->error().toString()));
+    buildJob.reset(nullptr);
+
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE(setupParams.projectFilePath(), "\"old\"", "\"new\"");
+    setupJob.reset(project.setupProject(setupParams, m_logSink, 0));
+    waitForFinished(setupJob.get());
+    QVERIFY2(!setupJob->error().hasError(), qPrintable(setupJob->error().toString()));
+    project = setupJob->project();
+    QCOMPARE(project.projectData().products().front().properties().value("content").toString(),
+             QString("new"));
+    setupJob.reset(nullptr);
+    project = qbs::Project(); // Releases the build graph lock.
+
+    setupParams.setRestoreBehavior(qbs::SetupProjectParameters::RestoreOnly);
+    setupJob.reset(qbs::Project().setupProject(setupParams, m_logSink, 0));
+    waitForFinished(setupJob.get());
+    QVERIFY2(!setupJob->error().hasError(), qPrintable(setupJob->error().toString()));
+    const qbs::ProjectData projectData = setupJob->project().projectData();
+    QCOMPARE(projectData.products().size(), 1);
+    QCOMPARE(projectData.products().front().properties().value("content").toString(),
+             QString("new"));
+}
+
 void TestApi::buildGraphInfo()
 {
     SettingsPtr s = settings();
@@ -353,6 +390,36 @@ void TestApi::buildGraphLocking()
     QVERIFY2(!QFileInfo(newLockFile).exists(), qPrintable(newLockFile));
 }
 
+void TestApi::buildGraphWriteFailure()
+{
+    // The build graph is written in the background after building, so the build job cannot
+    // report a failure of that write. It must still end up in the log.
+    qbs::SetupProjectParameters setupParams
+            = defaultSetupParameters("build-graph-write-failure");
+    removeBuildDir(setupParams);
+    std::unique_ptr<qbs::SetupProjectJob> setupJob(qbs::Project().setupProject(setupParams,
+                                                                              m_logSink, 0));
+    waitForFinished(setupJob.get());
+    QVERIFY2(!setupJob->error().hasError(), qPrintable(setupJob->error().toString()));
+    qbs::Project project = setupJob->project();
+    setupJob.reset(nullptr);
+
+    // The new build graph file cannot replace a non-empty directory.
+    const QString bgFilePath = setupParams.buildRoot() + QLatin1Char('/')
+            + relativeBuildGraphFilePath();
+    QVERIFY2(QFile::remove(bgFilePath), qPrintable(bgFilePath));
+    QVERIFY(QDir().mkpath(bgFilePath + QLatin1String("/blocker")));
+    std::unique_ptr<qbs::BuildJob> buildJob(project.buildAllProducts(qbs::BuildOptions()));
+    waitForFinished(buildJob.get());
+    QVERIFY2(!buildJob->error().hasError(), qPrintable(buildJob->error().toString()));
+    buildJob.reset(nullptr);
+    QCOMPARE(m_logSink->warnings.size(), 0);
+    project = qbs::Project(); // Waits for the write and releases the build graph lock.
+    QCOMPARE(m_logSink->warnings.size(), 1);
+    const QString warning = m_logSink->warnings.first().toString();
+    QVERIFY2(warning.contains("could not be stored"), qPrintable(warning));
+}
+
 void TestApi::buildProject()
 {
     QFETCH(QString, projectSubDir);
@@ -1412,6 +1479,18 @@ void TestApi::infiniteLoopResolving()
              qPrintable(setupJob->error().toString()));
 }
 
+void TestApi::infiniteLoopInProbes()
+{
+    // The configure scripts of these probes run concurrently in separate engines.
+    qbs::SetupProjectParameters setupParams = defaultSetupParameters("infinite-loop-in-probes");
+    std::unique_ptr<qbs::SetupProjectJob> setupJob(qbs::Project().setupProject(setupParams,
+                                                                              m_logSink, 0));
+    QTimer::singleShot(1000, setupJob.get(), &qbs::AbstractJob::cancel);
+    QVERIFY(waitForFinished(setupJob.get(), testTimeoutInMsecs()));
+    QVERIFY2(setupJob->error().toString().toLower().contains("cancel"),
+             qPrintable(setupJob->error().toString()));
+}
+
 void TestApi::inheritQbsSearchPaths()
 {
     const QString projectFilePath = "inherit-qbs-search-paths/prj.qbs";
@@ -60,8 +60,10 @@ private slots:
     void addedFilePersistent();
     void baseProperties();
     void buildErrorCodeLocation();
+    void buildGraphAfterReResolve();
     void buildGraphInfo();
     void buildGraphLocking();
+    void buildGraphWriteFailure();
     void buildProject();
     void buildProject_data();
     void buildProjectDryRun();
@@ -96,6 +98,7 @@ private slots:
     void infiniteLoopBuilding();
     void infiniteLoopBuilding_data();
     void infiniteLoopResolving();
+    void infiniteLoopInProbes();
     void inheritQbsSearchPaths();
     void installableFiles();
     void isRunnable();
@@ -2837,6 +2837,73 @@ void TestBlackbox::preventFloatingPointValues()
     QVERIFY2(m_qbsStdout.contains("version: 1.50"), m_qbsStdout.constData());
 }
 
+void TestBlackbox::probeCache()
+{
+    QDir::setCurrent(testDataDir + "/probe-cache");
+    QbsRunParameters params(QStringList("--log-time"));
+    params.environment.insert("QBS_PROBE_CACHE_DIR", QDir::currentPath() + "/probe-cache-dir");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("running probe"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("running process probe"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("probe result: done"), m_qbsStdout.constData());
+
+    // A fresh build directory re-uses the results.
+    rmDirR(relativeBuildDir());
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(!m_qbsStdout.contains("running probe"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("running process probe"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("probe result: done"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("2 re-used from probe cache"), m_qbsStdout.constData());
+
+    // Environment variables the probes did not read do not matter, not even for the one
+    // that starts a process.
+    rmDirR(relativeBuildDir());
+    params.environment.insert("QBS_PROBE_CACHE_UNRELATED_VARIABLE", "1");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(!m_qbsStdout.contains("running probe"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("running process probe"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("2 re-used from probe cache"), m_qbsStdout.constData());
+
+    // A copy of the project in another location, built in another build directory from
+    // another working directory, re-uses the results as well.
+    QTemporaryDir otherDir;
+    QVERIFY(otherDir.isValid());
+    const QString otherProjectDir = otherDir.path() + "/project";
+    QVERIFY(QDir().mkpath(otherProjectDir));
+    QVERIFY(QFile::copy("probe-cache.qbs", otherProjectDir + "/probe-cache.qbs"));
+    QbsRunParameters otherParams = params;
+    otherParams.arguments << "-f" << (otherProjectDir + "/probe-cache.qbs");
+    otherParams.buildDirectory = otherDir.path() + "/build";
+    otherParams.workingDir = otherDir.path();
+    otherParams.environment.insert("PWD", otherDir.path());
+    QCOMPARE(runQbs(otherParams), 0);
+    QVERIFY2(!m_qbsStdout.contains("running probe"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("running process probe"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("probe result: done"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("2 re-used from probe cache"), m_qbsStdout.constData());
+
+    // PATH is taken into account for the probe that starts a process.
+    rmDirR(relativeBuildDir());
+    params.environment.insert("PATH", params.environment.value("PATH")
+                              + HostOsInfo::pathListSeparator() + otherDir.path());
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(!m_qbsStdout.contains("running probe"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("running process probe"), m_qbsStdout.constData());
+
+    // A change in a variable the probe read invalidates the result.
+    rmDirR(relativeBuildDir());
+    params.environment.insert("QBS_PROBE_CACHE_TEST_VARIABLE", "1");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("running probe"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("probe result: done1"), m_qbsStdout.constData());
+
+    // The cache is opt-in.
+    rmDirR(relativeBuildDir());
+    params.environment.remove("QBS_PROBE_CACHE_DIR");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("running probe"), m_qbsStdout.constData());
+}
+
 void TestBlackbox::probeChangeTracking()
 {
     QDir::setCurrent(testDataDir + "/probe-change-tracking");
@@ -3764,6 +3831,14 @@ void TestBlackbox::inputsFromDependencies()
              m_qbsStdout.constData());
 }
 
+void TestBlackbox::inputsReassignment()
+{
+    QDir::setCurrent(testDataDir + "/inputs-reassignment");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("txt inputs: a.txt,c.txt"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("md inputs: 0"), m_qbsStdout.constData());
+}
+
 void TestBlackbox::installPackage()
 {
     if (HostOsInfo::hostOs() == HostOsInfo::HostOsWindows)
@@ -132,6 +132,7 @@ private slots:
     void inputTagsChangeTracking_data();
     void inputTagsChangeTracking();
     void inputsFromDependencies();
+    void inputsReassignment();
     void installable();
     void installableAsAuxiliaryInput();
     void installedApp();
@@ -208,6 +209,7 @@ private slots:
     void pluginDependency();
     void precompiledAndPrefixHeaders();
     void preventFloatingPointValues();
+    void probeCache();
     void probeChangeTracking();
     void probeProperties();
     void probesAndShadowProducts();
@@ -59,6 +59,7 @@
 #include <tools/fileinfo.h>
 #include <tools/hostosinfo.h>
 #include <tools/jsliterals.h>
+#include <tools/persistence.h>
 #include <tools/profile.h>
 #include <tools/qttools.h>
 #include <tools/settings.h>
@@ -66,7 +67,10 @@
 
 #include "../shared/logging/consolelogger.h"
 
+#include <QtCore/qdatetime.h>
+#include <QtCore/qfileinfo.h>
 #include <QtCore/qprocess.h>
+#include <QtCore/qtemporarydir.h>
 
 #include <algorithm>
 #include <set>
@@ -320,6 +324,20 @@ void TestLanguage::chainedProbes()
 
 }
 
+void TestLanguage::uniqueFlags()
+{
+    bool exceptionCaught = false;
+    try {
+        SetupProjectParameters parameters = defaultParameters;
+        parameters.setProjectFilePath(testProject("uniqueFlags.qbs"));
+        QVERIFY(!!loader->loadProject(parameters));
+    } catch (const ErrorInfo &e) {
+        exceptionCaught = true;
+        qDebug() << e.toString();
+    }
+    QCOMPARE(exceptionCaught, false);
+}
+
 void TestLanguage::versionCompare()
 {
     bool exceptionCaught = false;
@@ -369,6 +387,112 @@ void TestLanguage::rfc1034Identifier()
     QCOMPARE(exceptionCaught, false);
 }
 
+void TestLanguage::changedFileBetweenResolves()
+{
+    // Parsed files are kept across resolves, but must be re-read once they have changed.
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString projectFilePath = tempDir.path() + "/changed-file.qbs";
+    const auto writeProjectFile = [&projectFilePath](const QByteArray &value) {
+        QFile projectFile(projectFilePath);
+        if (!projectFile.open(QIODevice::WriteOnly))
+            return false;
+        projectFile.write("Product { name: 'p'; property string value: '" + value + "' }\n");
+        return true;
+    };
+    const auto resolvedValue = [this, &projectFilePath] {
+        SetupProjectParameters parameters = defaultParameters;
+        parameters.setProjectFilePath(projectFilePath);
+        const TopLevelProjectPtr project = loader->loadProject(parameters);
+        const QHash<QString, ResolvedProductPtr> products = productsFromProject(project);
+        const ResolvedProductPtr product = products.value("p");
+        return product ? product->productProperties.value("value").toString() : QString();
+    };
+
+    bool exceptionCaught = false;
+    try {
+        QVERIFY(writeProjectFile("old"));
+        QCOMPARE(resolvedValue(), QString("old"));
+
+        // Same size, so only the time stamp tells the versions apart.
+        waitForNewTimestamp(tempDir.path());
+        QVERIFY(writeProjectFile("new"));
+        QCOMPARE(resolvedValue(), QString("new"));
+
+        // Different size, but possibly the same time stamp.
+        QVERIFY(writeProjectFile("newer"));
+        QCOMPARE(resolvedValue(), QString("newer"));
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+        // Same size and same time stamp, as with two saves within the time stamp resolution
+        // of the file system. Only the content tells the versions apart.
+        const QDateTime lastModified = QFileInfo(projectFilePath).lastModified();
+        QVERIFY(writeProjectFile("fresh"));
+        QFile projectFile(projectFilePath);
+        QVERIFY(projectFile.open(QIODevice::ReadWrite));
+        QVERIFY(projectFile.setFileTime(lastModified, QFileDevice::FileModificationTime));
+        projectFile.close();
+        QCOMPARE(resolvedValue(), QString("fresh"));
+#endif
+    } catch (const ErrorInfo &e) {
+        exceptionCaught = true;
+        qDebug() << e.toString();
+    }
+    QCOMPARE(exceptionCaught, false);
+}
+
+void TestLanguage::concurrentProbes()
+{
+    bool exceptionCaught = false;
+    try {
+        SetupProjectParameters params = defaultParameters;
+        params.setProjectFilePath(testProject("concurrent-probes/concurrent-probes.qbs"));
+        const TopLevelProjectPtr project = loader->loadProject(params);
+        QVERIFY(!!project);
+        const QHash<QString, ResolvedProductPtr> products = productsFromProject(project);
+        const ResolvedProductConstPtr product = products.value("theProduct");
+        QVERIFY(!!product);
+        const QVariantMap plainResult
+                = product->productProperties.value("plainResult").toMap();
+        QCOMPARE(plainResult.value("list").toStringList(), QStringList({"a", "b"}));
+        QCOMPARE(plainResult.value("nested").toMap().value("number").toInt(), 1);
+        QCOMPARE(product->productProperties.value("dependentResult").toString(),
+                 QString("ab"));
+        QCOMPARE(product->productProperties.value("referringResult").toString(),
+                 QString("found"));
+        QCOMPARE(product->productProperties.value("dateResult").toDateTime()
+                 .toMSecsSinceEpoch(), qint64(0));
+        QCOMPARE(product->productProperties.value("instanceResult").toMap().value("x").toInt(),
+                 21);
+        QCOMPARE(product->productProperties.value("typedCount").toInt(), 2);
+        QCOMPARE(product->productProperties.value("typedLocation").toString(),
+                 QString("sub/dir"));
+    } catch (const ErrorInfo &e) {
+        exceptionCaught = true;
+        qDebug() << e.toString();
+    }
+    QCOMPARE(exceptionCaught, false);
+}
+
+void TestLanguage::concurrentProbesErrorLocation()
+{
+    bool exceptionCaught = false;
+    try {
+        SetupProjectParameters params = defaultParameters;
+        params.setProjectFilePath(testProject("concurrent-probes/concurrent-probes.qbs"));
+        params.setOverriddenValues({std::make_pair(
+                                    QString("products.theProduct.enableFailingProbe"), true)});
+        loader->loadProject(params);
+    } catch (const ErrorInfo &e) {
+        exceptionCaught = true;
+        QVERIFY2(e.toString().contains("Probe failed on purpose"), qPrintable(e.toString()));
+        const CodeLocation location = e.items().front().codeLocation();
+        QCOMPARE(FileInfo::fileName(location.filePath()), QString("concurrent-probes.qbs"));
+        QCOMPARE(location.line(), 52);
+    }
+    QCOMPARE(exceptionCaught, true);
+}
+
 void TestLanguage::conditionalDepends()
 {
     bool exceptionCaught = false;
@@ -2082,6 +2206,20 @@ void TestLanguage::modules()
     QCOMPARE(product->productProperties.value("foo").toString(), expectedProductProperty);
 }
 
+void TestLanguage::modUtilsHelpers()
+{
+    bool exceptionCaught = false;
+    try {
+        SetupProjectParameters parameters = defaultParameters;
+        parameters.setProjectFilePath(testProject("modUtilsHelpers.qbs"));
+        QVERIFY(!!loader->loadProject(parameters));
+    } catch (const ErrorInfo &e) {
+        exceptionCaught = true;
+        qDebug() << e.toString();
+    }
+    QCOMPARE(exceptionCaught, false);
+}
+
 void TestLanguage::multiplexedExports()
 {
     bool exceptionCaught = false;
@@ -2688,6 +2826,97 @@ void TestLanguage::propertyAssignmentInExportedGroup()
     QCOMPARE(exceptionCaught, false);
 }
 
+void TestLanguage::propertyMapInterner()
+{
+    const auto sharesData = [](const QVariantMap &m1, const QVariantMap &m2) {
+        return &m1.constBegin().value() == &m2.constBegin().value();
+    };
+    const auto createMap = [](const QVariant &value) {
+        QVariantMap nested;
+        nested.insert("defines", QStringList{"A", "B"});
+        QVariantMap map;
+        map.insert("nested", nested);
+        map.insert("value", value);
+        return map;
+    };
+
+    PropertyMapInterner interner;
+    const QVariantMap m1 = interner.intern(createMap(1));
+    const QVariantMap m2 = interner.intern(createMap(1));
+    QCOMPARE(m1, m2);
+    QVERIFY(sharesData(m1, m2));
+
+    const QVariantMap m3 = interner.intern(createMap(2));
+    QVERIFY(m1 != m3);
+    QVERIFY(!sharesData(m1, m3));
+
+    // Values that compare equal after conversion must not be merged.
+    const QVariantMap m4 = interner.intern(createMap(QString("1")));
+    QVERIFY(!sharesData(m1, m4));
+    QCOMPARE(m4.value("value").type(), QVariant::String);
+}
+
+void TestLanguage::propertyMapInternerPersistence()
+{
+    // Products with equal module properties share one map. Storing the build graph must
+    // write that map only once, and loading must share it between the products again.
+    const auto sharesData = [](const QVariantMap &m1, const QVariantMap &m2) {
+        return &m1.constBegin().value() == &m2.constBegin().value();
+    };
+    const auto moduleMap = [](const ResolvedProductConstPtr &product, const QString &module) {
+        return product->moduleProperties->value().value(module).toMap();
+    };
+
+    QVariantMap cppProperties;
+    cppProperties.insert("defines", QStringList{"A", "B"});
+    cppProperties.insert("optimization", "fast");
+    PropertyMapInterner interner;
+    std::vector<ResolvedProductPtr> products;
+    for (int i = 0; i < 3; ++i) {
+        const ResolvedProductPtr product = ResolvedProduct::create();
+        product->name = QString("p%1").arg(i);
+        QVariantMap qbsProperties;
+        qbsProperties.insert("architecture", QString("arch%1").arg(i));
+        QVariantMap moduleProperties;
+        moduleProperties.insert("cpp", interner.intern(cppProperties));
+        moduleProperties.insert("qbs", interner.intern(qbsProperties));
+        product->moduleProperties = PropertyMapInternal::create();
+        product->moduleProperties->setValue(moduleProperties);
+        products.push_back(product);
+    }
+    QVERIFY(sharesData(moduleMap(products.at(0), "cpp"), moduleMap(products.at(2), "cpp")));
+
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString filePath = tempDir.path() + "/shared-maps.bg";
+    std::vector<ResolvedProductPtr> loadedProducts;
+    try {
+        PersistentPool storePool(m_logger);
+        storePool.setupWriteStream(filePath);
+        storePool.store(products);
+        storePool.finalizeWriteStream();
+
+        PersistentPool loadPool(m_logger);
+        loadPool.load(filePath);
+        loadPool.load(loadedProducts);
+    } catch (const ErrorInfo &e) {
+        QFAIL(qPrintable(e.toString()));
+    }
+
+    QCOMPARE(loadedProducts.size(), products.size());
+    for (size_t i = 0; i < products.size(); ++i) {
+        QCOMPARE(loadedProducts.at(i)->name, products.at(i)->name);
+        QCOMPARE(loadedProducts.at(i)->moduleProperties->value(),
+                 products.at(i)->moduleProperties->value());
+        QVERIFY(sharesData(moduleMap(loadedProducts.at(i), "cpp"),
+                           moduleMap(loadedProducts.front(), "cpp")));
+        if (i > 0) {
+            QVERIFY(!sharesData(moduleMap(loadedProducts.at(i), "qbs"),
+                                moduleMap(loadedProducts.front(), "qbs")));
+        }
+    }
+}
+
 void TestLanguage::qbs1275()
 {
     bool exceptionCaught = false;
@@ -85,6 +85,9 @@ private slots:
     void builtinFunctionInSearchPathsProperty();
     void chainedProbes();
     void canonicalArchitecture();
+    void changedFileBetweenResolves();
+    void concurrentProbes();
+    void concurrentProbesErrorLocation();
     void conditionalDepends();
     void delayedError();
     void delayedError_data();
@@ -135,6 +138,7 @@ private slots:
     void moduleScope();
     void modules_data();
     void modules();
+    void modUtilsHelpers();
     void multiplexedExports();
     void multiplexingByProfile();
     void multiplexingByProfile_data();
@@ -157,6 +161,8 @@ private slots:
     void propertiesBlockInGroup();
     void propertiesItemInModule();
     void propertyAssignmentInExportedGroup();
+    void propertyMapInterner();
+    void propertyMapInternerPersistence();
     void qbs1275();
     void qbsPropertiesInProjectCondition();
     void qbsPropertyConvenienceOverride();
@@ -172,6 +178,7 @@ private slots:
     void qualifiedId();
     void recursiveProductDependencies();
     void rfc1034Identifier();
+    void uniqueFlags();
     void versionCompare();
     void wildcards_data();
     void wildcards();
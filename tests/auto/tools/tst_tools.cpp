@@ -43,6 +43,7 @@
 
 #include "../shared.h"
 
+#include <language/filetags.h>
 #include <tools/buildoptions.h>
 #include <tools/error.h>
 #include <tools/fileinfo.h>
@@ -54,6 +55,7 @@
 #include <tools/settings.h>
 #include <tools/setupprojectparameters.h>
 #include <tools/stringutils.h>
+#include <tools/vectormap.h>
 #include <tools/version.h>
 
 #include <QtCore/qdir.h>
@@ -65,6 +67,9 @@
 
 #include <QtTest/qtest.h>
 
+#include <algorithm>
+#include <random>
+
 using namespace qbs;
 using namespace qbs::Internal;
 
@@ -249,6 +254,58 @@ void TestTools::fileCaseCheck()
         QVERIFY(!FileInfo::isFileCaseCorrect(upperFilePath));
 }
 
+void TestTools::fileTagMask()
+{
+    QVERIFY(FileTagMask().empty());
+    QVERIFY(!FileTagMask().intersects(FileTags{"cpp"}));
+
+    const FileTagMask mask(FileTags{"cpp", "hpp"});
+    QVERIFY(!mask.empty());
+    QVERIFY(mask.contains("cpp"));
+    QVERIFY(mask.contains("hpp"));
+    QVERIFY(!mask.contains("obj"));
+    QVERIFY(mask.intersects(FileTags{"application", "hpp"}));
+    QVERIFY(!mask.intersects(FileTags{"application", "obj"}));
+    QVERIFY(!mask.intersects(FileTags()));
+
+    FileTagMask mask2;
+    mask2.unite(FileTags{"obj"});
+    mask2.unite(FileTags{FileTag(Id::fromUniqueIdentifier(1))});
+    QVERIFY(mask2.contains("obj"));
+    QVERIFY(mask2.contains(FileTag(Id::fromUniqueIdentifier(1))));
+    QVERIFY(!mask2.contains(FileTag(Id::fromUniqueIdentifier(2))));
+    QVERIFY(!mask2.contains("cpp"));
+}
+
+void TestTools::testVectorMap()
+{
+    VectorMap<QString, int> map;
+    QVERIFY(map.empty());
+    map.insert("b", 2);
+    map.insert("c", 3);
+    map.insert("a", 1);
+    map["d"] = 4;
+    map.insert("c", 30);
+    QCOMPARE(map.size(), 4);
+    QCOMPARE(QStringList(map.keys()), QStringList({"a", "b", "c", "d"}));
+    QCOMPARE(map.value("c"), 30);
+    QCOMPARE(map.value("e", -1), -1);
+    QVERIFY(map.contains("a"));
+    QVERIFY(!map.contains("e"));
+    QVERIFY(map.constFind("e") == map.constEnd());
+    QCOMPARE(map.constFind("b").value(), 2);
+    QCOMPARE(std::accumulate(map.cbegin(), map.cend(), 0), 40);
+
+    const VectorMap<QString, int> copy = map;
+    QCOMPARE(map.remove("a"), 1);
+    QCOMPARE(map.remove("a"), 0);
+    QCOMPARE(map.size(), 3);
+    QCOMPARE(copy.size(), 4);
+    QVERIFY(copy != map);
+    map.insert("a", 1);
+    QVERIFY(copy == map);
+}
+
 void TestTools::testProfiles()
 {
     TemporaryProfile tpp("parent", m_settings);
@@ -1087,6 +1144,71 @@ void TestTools::set_intersects()
     QVERIFY(s1.intersects(s3));
 }
 
+void TestTools::set_largeSetOperations()
+{
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> distribution(0, 20000);
+    std::set<int> stdSet1;
+    std::set<int> stdSet2;
+    for (int i = 0; i < 10000; ++i) {
+        stdSet1.insert(distribution(generator));
+        stdSet2.insert(distribution(generator));
+    }
+    const Set<int> set1 = Set<int>::fromStdSet(stdSet1);
+    const Set<int> set2 = Set<int>::fromStdSet(stdSet2);
+
+    std::set<int> expected = stdSet1;
+    expected.insert(stdSet2.cbegin(), stdSet2.cend());
+    QVERIFY(Set<int>(set1).unite(set2).toStdSet() == expected);
+
+    expected.clear();
+    std::set_difference(stdSet1.cbegin(), stdSet1.cend(), stdSet2.cbegin(), stdSet2.cend(),
+                        std::inserter(expected, expected.end()));
+    QVERIFY(Set<int>(set1).subtract(set2).toStdSet() == expected);
+
+    expected.clear();
+    std::set_intersection(stdSet1.cbegin(), stdSet1.cend(), stdSet2.cbegin(), stdSet2.cend(),
+                          std::inserter(expected, expected.end()));
+    QVERIFY(Set<int>(set1).intersect(set2).toStdSet() == expected);
+}
+
+void TestTools::set_bulkOperationEdgeCases()
+{
+    const Set<int> empty;
+    const Set<int> set{1, 3, 5};
+    QVERIFY(Set<int>(empty).unite(empty) == empty);
+    QVERIFY(Set<int>(empty).unite(set) == set);
+    QVERIFY(Set<int>(set).unite(empty) == set);
+    QVERIFY(Set<int>(empty).subtract(set) == empty);
+    QVERIFY(Set<int>(set).subtract(empty) == set);
+    QVERIFY(Set<int>(empty).intersect(set) == empty);
+    QVERIFY(Set<int>(set).intersect(empty) == empty);
+
+    Set<int> self = set;
+    QVERIFY(self.unite(self) == set);
+    QVERIFY(self.intersect(self) == set);
+    QVERIFY(self.subtract(self) == empty);
+
+    const Set<int> before{-2, 0};
+    const Set<int> after{6, 7};
+    const Set<int> interleaved{0, 2, 4, 6};
+    QVERIFY(Set<int>(set).unite(before) == Set<int>({-2, 0, 1, 3, 5}));
+    QVERIFY(Set<int>(set).unite(after) == Set<int>({1, 3, 5, 6, 7}));
+    QVERIFY(Set<int>(set).unite(interleaved) == Set<int>({0, 1, 2, 3, 4, 5, 6}));
+    QVERIFY(Set<int>(set).subtract(before) == set);
+    QVERIFY(Set<int>(set).subtract(interleaved) == set);
+    QVERIFY(Set<int>(set).intersect(after) == empty);
+    QVERIFY(Set<int>(set).intersect(interleaved) == empty);
+
+    const Set<int> superset{0, 1, 2, 3, 4, 5};
+    QVERIFY(Set<int>(set).unite(superset) == superset);
+    QVERIFY(Set<int>(superset).unite(set) == superset);
+    QVERIFY(Set<int>(set).subtract(superset) == empty);
+    QVERIFY(Set<int>(superset).subtract(set) == Set<int>({0, 2, 4}));
+    QVERIFY(Set<int>(set).intersect(superset) == set);
+    QVERIFY(Set<int>(superset).intersect(set) == set);
+}
+
 void TestTools::stringutils_join()
 {
     QFETCH(std::vector<std::string>, input);
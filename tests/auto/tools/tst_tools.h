@@ -63,12 +63,14 @@ private slots:
     void fileSaver();
 
     void fileCaseCheck();
+    void fileTagMask();
     void testBuildConfigMerging();
     void testFileInfo();
     void testProcessNameByPid();
     void testProfiles();
     void testSettingsMigration();
     void testSettingsMigration_data();
+    void testVectorMap();
 
     void set_operator_eq();
     void set_swap();
@@ -89,6 +91,8 @@ private slots:
     void set_makeSureTheComfortFunctionsCompile();
     void set_initializerList();
     void set_intersects();
+    void set_largeSetOperations();
+    void set_bulkOperationEdgeCases();
 
     void stringutils_join();
     void stringutils_join_data();